@@ -0,0 +1,159 @@
+#!/bin/sh
+# Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+#                        http://www.antiprism.com/other/bracelet_solver/
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+#   The above copyright notice and this permission notice shall be included
+#   in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+
+# Run the benchmark corpus with bracelet_solver, and report the time,
+# descents per second, peak memory and a checksum of the report for each
+# case. The results are written to a file, which may be given as the
+# baseline of a later run to compare against.
+
+usage()
+{
+  cat <<USAGE
+Usage: $0 [options]
+
+Options
+  -h          print this help text
+  -s <path>   bracelet_solver program to run (default: bracelet_solver in
+              the build src directory, or on the PATH)
+  -c <file>   corpus file (default: corpus.txt next to this script)
+  -o <file>   file to write the results to (default: bench-results.txt)
+  -b <file>   results file of a baseline run to compare against. The exit
+              status is 1 if any report checksum differs
+  -q          quick, only run the cases of the quick tier
+  -n <name>   only run the cases with names starting with name
+USAGE
+}
+
+bench_dir=$(cd "$(dirname "$0")" && pwd)
+solver=
+corpus="$bench_dir/corpus.txt"
+results=bench-results.txt
+baseline=
+quick=0
+only=
+
+while getopts "hs:c:o:b:qn:" opt; do
+  case $opt in
+  h) usage; exit 0 ;;
+  s) solver=$OPTARG ;;
+  c) corpus=$OPTARG ;;
+  o) results=$OPTARG ;;
+  b) baseline=$OPTARG ;;
+  q) quick=1 ;;
+  n) only=$OPTARG ;;
+  *) usage >&2; exit 2 ;;
+  esac
+done
+
+if [ -z "$solver" ]; then
+  if [ -x src/bracelet_solver ]; then
+    solver=src/bracelet_solver
+  else
+    solver=bracelet_solver
+  fi
+fi
+if ! "$solver" -v >/dev/null 2>&1; then
+  echo "$0: cannot run solver '$solver'" >&2
+  exit 2
+fi
+corpus_dir="$(cd "$(dirname "$corpus")" && pwd)/"
+if [ -n "$baseline" ] && [ ! -r "$baseline" ]; then
+  echo "$0: cannot read baseline file '$baseline'" >&2
+  exit 2
+fi
+
+# time in seconds, to nanoseconds where date supports it
+now()
+{
+  date +%s.%N | sed 's/\.N$/.0/'
+}
+
+# value of a number field of a JSON object on one line
+json_num()
+{
+  sed -n "s/.*\"$2\":\([-0-9.e+]*\).*/\1/p" "$1"
+}
+
+tmp_dir=$(mktemp -d "${TMPDIR:-/tmp}/bench.XXXXXX") || exit 2
+trap 'rm -rf "$tmp_dir"' EXIT INT TERM
+
+echo "# bracelet_solver bench 1" >"$results"
+echo "# name	seconds	descents	descents_per_sec	max_rss_kb	solutions	checksum" >>"$results"
+
+printf "%-18s %9s %12s %12s %9s %9s  %s\n" case seconds descents \
+  descents/s rss_kb solutions checksum
+grep -v '^[ 	]*\(#\|$\)' "$corpus" | while read -r tier name design opts; do
+  [ "$quick" = 1 ] && [ "$tier" != quick ] && continue
+  case $name in "$only"*) ;; *) continue ;; esac
+  case $design in /*) ;; *) design="$corpus_dir$design" ;; esac
+  start=$(now)
+  # shellcheck disable=SC2086
+  "$solver" -q $opts --stats-json "$tmp_dir/stats.json" "$design" \
+    >"$tmp_dir/report.txt"
+  status=$?
+  end=$(now)
+  if [ $status -ne 0 ]; then
+    echo "$0: case $name: solver failed with status $status" >&2
+    continue
+  fi
+  secs=$(echo "$start $end" | awk '{printf "%.3f", $2 - $1}')
+  descents=$(json_num "$tmp_dir/stats.json" descents)
+  rate=$(json_num "$tmp_dir/stats.json" descents_per_sec)
+  rss=$(json_num "$tmp_dir/stats.json" max_rss_kb)
+  solns=$(grep -c '^SOLUTION' "$tmp_dir/report.txt")
+  sum=$(cksum <"$tmp_dir/report.txt" | awk '{print $1}')
+  rate=$(echo "$rate" | awk '{printf "%.0f", $1}')
+  printf "%-18s %9s %12s %12s %9s %9s  %s\n" "$name" "$secs" "$descents" \
+    "$rate" "$rss" "$solns" "$sum"
+  printf "%s\t%s\t%s\t%s\t%s\t%s\t%s\n" "$name" "$secs" "$descents" "$rate" \
+    "$rss" "$solns" "$sum" >>"$results"
+done
+
+echo "results written to $results"
+[ -z "$baseline" ] && exit 0
+
+# Compare with the baseline, matching the cases by name
+echo
+echo "comparison with baseline $baseline"
+awk -F '\t' '
+  /^#/ { next }
+  FNR == NR { secs[$1] = $2; rate[$1] = $4; sum[$1] = $7; next }
+  {
+    if (!($1 in secs)) {
+      printf "%-18s not in baseline\n", $1
+      next
+    }
+    speedup = ($2 > 0) ? secs[$1] / $2 : 0
+    same = (sum[$1] == $7) ? "same" : "DIFFERENT"
+    if (same != "same")
+      bad = 1
+    printf "%-18s %9s -> %9s  x%.2f  report %s\n", $1, secs[$1], $2,
+           speedup, same
+    base_total += secs[$1]
+    total += $2
+  }
+  END {
+    if (total > 0)
+      printf "%-18s %9.3f -> %9.3f  x%.2f\n", "total", base_total, total,
+             base_total / total
+    exit bad
+  }' "$baseline" "$results"
@@ -0,0 +1,207 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "anneal.h"
+#include <algorithm>
+#include <chrono>
+#include <limits.h>
+#include <math.h>
+
+using std::vector;
+
+// energy cost of a knot that is unmet, redundant, or a string that doesn't
+// return to its start position
+static const int penalty_weight = 2;
+
+// temperatures at the start and end of a round
+static const double temp_start = 2.0;
+static const double temp_end = 0.02;
+
+enum { move_knot = 0, move_swap, move_colour };
+
+AnnealSearch::AnnealSearch(const KnotColors &k, bool pure, bool symmetric,
+                           unsigned int rnd_seed)
+    : kc(k), prefer_pure(pure), only_symmetric(symmetric), seed(rnd_seed),
+      best_round(-1), rounds(0)
+{
+  num_knots = 0;
+  knots.resize(k.knots.size());
+  for (unsigned int i = 0; i < k.knots.size(); i++) {
+    knots[i].resize(k.knots[i].size());
+    num_knots += k.knots[i].size();
+  }
+  steps_per_round = std::max(20000L, 2000L * num_knots);
+}
+
+// Follow the strings through the knot lines, as in Pattern::check_line()
+int AnnealSearch::energy(int *score, int *penalties)
+{
+  *score = 0;
+  *penalties = 0;
+  strings_end = strings;
+  for (unsigned int i = 0; i < knots.size(); i++) {
+    const int first = i % 2; // first string that will be knotted
+    const vector<int> &colours = kc.knots[i];
+    for (unsigned int j = 0; j < colours.size(); j++) {
+      int &left = strings_end[first + 2 * j];
+      int &right = strings_end[first + 2 * j + 1];
+      if (colours[j] != left && colours[j] != right)
+        (*penalties)++; // unmet knot
+      if (left == right)
+        *penalties += (knots[i][j] != prefer_pure); // redundant
+      else
+        *score += (knots[i][j] != prefer_pure);
+      if (knots[i][j])
+        std::swap(left, right);
+    }
+  }
+
+  for (unsigned int i = 0; i < strings.size(); i++)
+    *penalties += (strings_end[i] != strings[i]); // wrap mismatch
+
+  return *score + penalty_weight * *penalties;
+}
+
+void AnnealSearch::flip_knot(int line, int idx)
+{
+  vector<int> &line_knots = knots[line];
+  line_knots[idx] = !line_knots[idx];
+  const int mirror = (int)line_knots.size() - 1 - idx;
+  if (only_symmetric && mirror != idx)
+    line_knots[mirror] = line_knots[idx];
+}
+
+void AnnealSearch::randomise()
+{
+  // the required strings of each colour, then the free strings
+  strings.clear();
+  for (int i = 0; i < kc.num_colours; i++)
+    strings.insert(strings.end(), kc.req_colour_cnts[i], i);
+  std::uniform_int_distribution<int> rnd_colour(0, kc.num_colours - 1);
+  while ((int)strings.size() < kc.num_strings)
+    strings.push_back(rnd_colour(rng));
+  std::shuffle(strings.begin(), strings.end(), rng);
+
+  for (unsigned int i = 0; i < knots.size(); i++)
+    for (unsigned int j = 0; j < knots[i].size(); j++)
+      knots[i][j] = rng() & 1;
+  if (only_symmetric)
+    for (unsigned int i = 0; i < knots.size(); i++)
+      for (unsigned int j = 0; j < knots[i].size() / 2; j++)
+        knots[i][knots[i].size() - 1 - j] = knots[i][j];
+}
+
+// Make a random move, recording it in move so it can be undone
+void AnnealSearch::make_move(vector<int> &move)
+{
+  const int num_strings = strings.size();
+  std::uniform_int_distribution<int> rnd_string(0, num_strings - 1);
+  const int type = rng() % 100;
+  if (type < 80) { // flip a knot
+    int knot = rng() % num_knots;
+    int line = 0;
+    while (knot >= (int)knots[line].size())
+      knot -= knots[line++].size();
+    flip_knot(line, knot);
+    move = {move_knot, line, knot};
+  }
+  else if (type < 95) { // swap two start strings
+    const int idx0 = rnd_string(rng);
+    const int idx1 = rnd_string(rng);
+    std::swap(strings[idx0], strings[idx1]);
+    move = {move_swap, idx0, idx1};
+  }
+  else { // change the colour of a free start string
+    const int idx = rnd_string(rng);
+    const int old_col = strings[idx];
+    const int new_col = rng() % kc.num_colours;
+    if (std::count(strings.begin(), strings.end(), old_col) >
+        kc.req_colour_cnts[old_col])
+      strings[idx] = new_col;
+    move = {move_colour, idx, old_col};
+  }
+}
+
+void AnnealSearch::undo_move(const vector<int> &move)
+{
+  if (move[0] == move_knot)
+    flip_knot(move[1], move[2]);
+  else if (move[0] == move_swap)
+    std::swap(strings[move[1]], strings[move[2]]);
+  else
+    strings[move[1]] = move[2];
+}
+
+bool AnnealSearch::run(double time_limit, Pattern &best,
+                       const AnnealRoundFunction &round)
+{
+  typedef std::chrono::steady_clock Clock;
+  const Clock::time_point start_time = Clock::now();
+  auto out_of_time = [&]() {
+    return std::chrono::duration<double>(Clock::now() - start_time).count() >=
+           time_limit;
+  };
+  std::uniform_real_distribution<double> rnd_prob(0.0, 1.0);
+  const double cooling = pow(temp_end / temp_start, 1.0 / steps_per_round);
+  int best_score = INT_MAX;
+  vector<int> move;
+  best_round = -1;
+  rounds = 0;
+  do {
+    std::seed_seq seq = {seed, (unsigned int)rounds};
+    rng.seed(seq);
+    randomise();
+    int score, penalties;
+    int cur_energy = energy(&score, &penalties);
+    double temp = temp_start;
+    long step;
+    for (step = 0; step < steps_per_round; step++, temp *= cooling) {
+      // a round of a large design may take minutes
+      if ((step & 1023) == 1023 && out_of_time())
+        break;
+      make_move(move);
+      const int new_energy = energy(&score, &penalties);
+      const int delta = new_energy - cur_energy;
+      if (delta <= 0 || rnd_prob(rng) < exp(-delta / temp)) {
+        cur_energy = new_energy;
+        if (!penalties && score < best_score) {
+          best_score = score;
+          best_round = rounds;
+          best.strings = strings;
+          best.knots = knots;
+          best.score = score;
+        }
+      }
+      else
+        undo_move(move);
+    }
+    if (step < steps_per_round) // stopped by the time limit
+      break;
+    if (round)
+      round(rounds, best_round >= 0 ? best_score : -1);
+    rounds++;
+  } while (!out_of_time());
+
+  best.prefer_pure = prefer_pure;
+  return best_round >= 0;
+}
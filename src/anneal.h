@@ -0,0 +1,94 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file anneal.h
+   \brief stochastic search for a good solution of a large design
+*/
+
+#ifndef ANNEAL_H
+#define ANNEAL_H
+
+#include "knotcolors.h"
+#include "pattern.h"
+#include <functional>
+#include <random>
+#include <vector>
+
+/// Function called at the end of each round of an annealing search
+/** Called with the number of the round, and the best score found so
+ *  far, or -1 if no solution has been found. */
+typedef std::function<void(int, int)> AnnealRoundFunction;
+
+/// Search for a good solution by simulated annealing
+/** The search is over the start strings and the knots of every line,
+ *  with the same knotting rules as the exhaustive search. The energy of
+ *  a candidate is its score, plus a penalty for each knot that is not
+ *  met by a string of its colour, and for each string that doesn't
+ *  return to its start position. A candidate with no penalties is a
+ *  valid solution. The search is made in rounds, each a complete
+ *  annealing run from a random candidate, until a time limit is reached.
+ *  A round only depends on the seed and its number, so the best solution
+ *  can be reproduced with the same seed and enough time to reach it. */
+class AnnealSearch {
+private:
+  const KnotColors &kc;
+  bool prefer_pure;
+  bool only_symmetric;
+  unsigned int seed;
+  int num_knots;
+  long steps_per_round;
+
+  std::mt19937_64 rng;
+  std::vector<int> strings;            // start strings
+  std::vector<std::vector<int>> knots; // knots (swap strings or not)
+  std::vector<int> strings_end;        // working strings for energy()
+
+  int energy(int *score, int *penalties);
+  void randomise();
+  void make_move(std::vector<int> &move);
+  void undo_move(const std::vector<int> &move);
+  void flip_knot(int line, int idx);
+
+public:
+  int best_round; ///< the round the best solution was found in, or -1
+  int rounds;     ///< the number of rounds completed
+
+  /// Constructor
+  /**\param k the design.
+   * \param pure whether pure knots are preferred.
+   * \param symmetric only look for symmetric knottings.
+   * \param rnd_seed the seed for the random choices. */
+  AnnealSearch(const KnotColors &k, bool pure, bool symmetric,
+               unsigned int rnd_seed);
+
+  /// Run the search
+  /**\param time_limit the number of seconds to search for. The clock
+   *  is checked during each round, and a round still running at the
+   *  limit is stopped, and not counted in \c rounds.
+   * \param best used to return the best solution found.
+   * \param round if given, called at the end of each round.
+   * \return \c true if a valid solution was found. */
+  bool run(double time_limit, Pattern &best,
+           const AnnealRoundFunction &round = AnnealRoundFunction());
+};
+
+#endif // ANNEAL_H
@@ -0,0 +1,163 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file bands.cc
+   \brief solve a design that repeats across its width as a narrower band
+*/
+
+#include "bands.h"
+#include "knotcolors.h"
+#include "pattern.h"
+#include "solutions.h"
+#include "verify.h"
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+int get_band_knots(const KnotColors &k)
+{
+  if (k.knots.size() < 2 || k.num_strings % 2)
+    return 0;
+
+  const int nk = k.knots[0].size();
+  for (int p = 2; p < nk; p++) {
+    if (nk % p)
+      continue;
+    bool repeats = true;
+    for (const auto &line : k.knots) {
+      for (unsigned int j = p; j < line.size(); j++) {
+        if (line[j] != line[j % p]) {
+          repeats = false;
+          break;
+        }
+      }
+      if (!repeats)
+        break;
+    }
+    if (repeats)
+      return p;
+  }
+  return 0;
+}
+
+// Repeat a band solution across the width of the design. The knots
+// between the bands are chosen as the strings reach them, and are
+// checked later with the rest of the solution.
+static Pattern tile_band(const Pattern &band_pat, const vector<int> &to_full,
+                         int band_knots, int reps, bool prefer_pure)
+{
+  const int band_strs = 2 * band_knots;
+  Pattern pat;
+  pat.set_prefer_pure(prefer_pure);
+  pat.strings.resize(reps * band_strs);
+  for (unsigned int i = 0; i < pat.strings.size(); i++)
+    pat.strings[i] = to_full[band_pat.strings[i % band_strs]];
+
+  vector<int> strs = pat.strings;
+  pat.knots.resize(band_pat.knots.size());
+  for (unsigned int line = 0; line < band_pat.knots.size(); line++) {
+    const vector<int> &band_line = band_pat.knots[line];
+    vector<int> &knots = pat.knots[line];
+    for (int r = 0; r < reps; r++) {
+      knots.insert(knots.end(), band_line.begin(), band_line.end());
+      if (line % 2 && r < reps - 1) {
+        const int left = strs[(r + 1) * band_strs - 1];
+        const int right = strs[(r + 1) * band_strs];
+        knots.push_back(left == right ? prefer_pure : 0);
+      }
+    }
+    strs = get_next_strings(strs, knots, line % 2);
+  }
+  return pat;
+}
+
+bool solve_bands(const KnotColors &k, int band_knots, const SolveOpts &opts,
+                 SolutionStore &solns)
+{
+  if (band_knots < 2)
+    return false;
+
+  // The band has the first knots of each line of the design
+  vector<string> lines(k.knots.size());
+  for (unsigned int i = 0; i < k.knots.size(); i++)
+    for (int j = 0; j < band_knots - (int)(i % 2); j++)
+      lines[i] += k.get_colour(k.knots[i][j]);
+
+  KnotColors band;
+  if (!band.read(lines) || band.num_free_strings < 0 ||
+      (opts.only_symmetric && !band.is_symmetric))
+    return false;
+
+  vector<int> to_full(band.num_colours);
+  for (int c = 0; c < band.num_colours; c++)
+    to_full[c] = k.get_idx(band.get_colour(c));
+
+  // Every band solution reported by the search is tried, including those
+  // later replaced by band solutions with a better score, as these may
+  // be the only ones that can be repeated across the width
+  const int reps = k.knots[0].size() / band_knots;
+  SolutionVerifier verifier(k, opts.prefer_pure);
+  vector<Pattern> pats;
+  SolveOpts band_opts = opts;
+  band_opts.cache = nullptr;
+  band_opts.solution = [&](const Pattern &band_pat) {
+    Pattern pat =
+        tile_band(band_pat, to_full, band_knots, reps, opts.prefer_pure);
+    if (!verifier.check(pat, &pat.score) ||
+        (pats.size() && pat.score > pats[0].score))
+      return;
+    if (pats.size() && pat.score < pats[0].score)
+      pats.clear();
+    if (!k.get_start_refs(pat.strings, &pat.soln_strs_no,
+                          &pat.soln_perm_no)) {
+      pat.soln_strs_no = -1; // too many permutations to number
+      pat.soln_perm_no = -1;
+    }
+    pat.soln_var_no = band_pat.soln_var_no;
+    pats.push_back(pat);
+    if (opts.solution)
+      opts.solution(pat);
+  };
+  if (opts.progress) {
+    band_opts.progress = [&opts, &k, &to_full](const SolveProgress &prog) {
+      vector<int> free_strings(k.num_colours, 0);
+      for (unsigned int c = 0; c < prog.free_strings.size(); c++)
+        free_strings[to_full[c]] = prog.free_strings[c];
+      vector<int> strings(prog.strings.size());
+      for (unsigned int i = 0; i < prog.strings.size(); i++)
+        strings[i] = to_full[prog.strings[i]];
+      SolveProgress full_prog = {prog.strs_no, prog.perm_no, free_strings,
+                                 strings, prog.descents};
+      opts.progress(full_prog);
+    };
+  }
+
+  band.solve(band_opts);
+
+  solns.init(k, opts.prefer_pure);
+  for (const auto &pat : pats)
+    solns.add(pat, pat.score);
+  return !pats.empty();
+}
@@ -0,0 +1,64 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file bands.h
+   \brief solve a design that repeats across its width as a narrower band
+*/
+
+#ifndef BANDS_H
+#define BANDS_H
+
+class KnotColors;
+class SolveOpts;
+class SolutionStore;
+
+/// Find the narrowest band that a design repeats across its width
+/** The knots of every line must repeat with the same period, and the
+ *  design must have an even number of strings, so that each band has
+ *  the same strings and each odd line has a knot between the bands.
+ * \param k the design.
+ * \return the number of knots in the even lines of the band, or 0 if the
+ *  design does not repeat across its width. */
+int get_band_knots(const KnotColors &k);
+
+/// Solve a design by solving a band of it and repeating the solutions
+/** The band is solved as a design of its own. Each band solution found
+ *  by the search, including those later replaced by better band
+ *  solutions, is repeated across the width, with the knots between the
+ *  bands leaving the strings in place (or swapping strings of the same
+ *  colour, for the pure knot type), so that each band keeps its strings.
+ *  A repeated solution is only kept if the knots between the bands are
+ *  met by their strings, and only the solutions with the best score are
+ *  kept. The solutions are solutions of the whole design, but may not
+ *  have the best score that a search of the whole design would find.
+ * \param k the design.
+ * \param band_knots the number of knots in the even lines of the band, as
+ *  returned by get_band_knots().
+ * \param opts the options (the cache is not used, and the progress is
+ *  reported with the colours of the whole design).
+ * \param solns used to return the solutions of the whole design.
+ * \return \c true if any band solution could be repeated across the
+ *  width, otherwise \c false, and the whole design should be searched. */
+bool solve_bands(const KnotColors &k, int band_knots, const SolveOpts &opts,
+                 SolutionStore &solns);
+
+#endif // BANDS_H
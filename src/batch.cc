@@ -0,0 +1,196 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "batch.h"
+#include "threadpool.h"
+#include "utils.h"
+#include <algorithm>
+#include <chrono>
+#include <ctype.h>
+#include <set>
+#include <string.h>
+
+using std::string;
+using std::vector;
+
+static bool is_separator(const string &line)
+{
+  return line.compare(0, 3, "---") == 0;
+}
+
+Status read_batch_designs(const string &fname, vector<BatchDesign> &designs)
+{
+  string fpath = fname;
+  FILE *ifile = fopen_file(fpath);
+  if (!ifile)
+    return Status::error(
+        msg_str("could not open knot colours file '%s'", fname.c_str()));
+
+  string base = fname;
+  const size_t slash = base.find_last_of('/');
+  if (slash != string::npos)
+    base = base.substr(slash + 1);
+
+  vector<BatchDesign> file_designs(1);
+  char *line = nullptr;
+  int line_no = 0;
+  while (read_line(ifile, &line) == 0) {
+    string text = line;
+    free(line);
+    line = nullptr;
+    line_no++;
+    if (is_separator(text)) {
+      file_designs.push_back(BatchDesign());
+      vector<char *> parts;
+      char *name = &text[3];
+      if (split_line(name, parts) > 0) {
+        // the name is used for the report file, in the output directory
+        if (strchr(parts[0], '/')) {
+          fclose(ifile);
+          return Status::error(
+              msg_str("%s: line %d: design name '%s' contains '/'",
+                      fname.c_str(), line_no, parts[0]));
+        }
+        file_designs.back().name = parts[0];
+      }
+    }
+    else
+      file_designs.back().lines.push_back(text);
+  }
+  free(line);
+  fclose(ifile);
+
+  // a separator may come before the first design
+  if (file_designs.size() > 1 && file_designs[0].lines.empty())
+    file_designs.erase(file_designs.begin());
+
+  // names must be unique, or the designs would share a report file
+  std::set<string> names;
+  for (const auto &design : designs)
+    names.insert(design.name);
+
+  for (unsigned int i = 0; i < file_designs.size(); i++) {
+    BatchDesign &design = file_designs[i];
+    if (design.name == "")
+      design.name = (file_designs.size() > 1)
+                        ? msg_str("%s-%d", base.c_str(), i + 1)
+                        : base;
+    const string name = design.name;
+    for (int n = 2; names.count(design.name); n++)
+      design.name = msg_str("%s-%d", name.c_str(), n);
+    names.insert(design.name);
+    designs.push_back(design);
+  }
+  return Status::ok();
+}
+
+static void solve_design(const BatchDesign &design, const SolveOpts &opts,
+                         const BatchReportFunction &report,
+                         const string &out_dir, BatchResult &result)
+{
+  auto start = std::chrono::steady_clock::now();
+  KnotColors k;
+  result.stat = k.read(design.lines);
+  if (result.stat) {
+    result.num_lines = k.knots.size();
+    result.num_strings = k.num_strings;
+  }
+
+  string fname = out_dir + "/" + design.name + ".out";
+  FILE *ofile = nullptr;
+  if (result.stat && !(ofile = fopen(fname.c_str(), "w")))
+    result.stat.set_error(
+        msg_str("could not open report file '%s'", fname.c_str()));
+
+  if (result.stat) {
+    SolutionStore solns;
+    if (k.num_free_strings >= 0) {
+      SolveOpts design_opts = opts;
+      design_opts.only_symmetric = opts.only_symmetric && k.is_symmetric;
+      solns = k.solve(design_opts);
+      result.num_solutions = solns.size();
+      if (solns.size())
+        result.best_score = solns.score(0);
+    }
+    else
+      result.stat.set_error("pattern cannot be made");
+    report(ofile, k, solns);
+    fclose(ofile);
+  }
+
+  result.secs = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+}
+
+vector<BatchResult> solve_batch(const vector<BatchDesign> &designs,
+                                const SolveOpts &opts,
+                                const BatchReportFunction &report,
+                                const string &out_dir, int num_threads)
+{
+  vector<BatchResult> results(designs.size());
+  ThreadPool pool(num_threads);
+  for (unsigned int i = 0; i < designs.size(); i++) {
+    // the work grows quickly with the size of the design, so start the
+    // designs with the most knots first, to balance the load at the end
+    int num_knots = 0;
+    for (const auto &line : designs[i].lines)
+      for (char c : line)
+        num_knots += !isspace(c);
+    pool.add(
+        [&, i] { solve_design(designs[i], opts, report, out_dir, results[i]); },
+        num_knots);
+  }
+  pool.wait();
+  return results;
+}
+
+void print_batch_summary(FILE *ofile, const vector<BatchDesign> &designs,
+                         const vector<BatchResult> &results)
+{
+  size_t name_width = strlen("design");
+  for (const auto &design : designs)
+    name_width = std::max(name_width, design.name.size());
+
+  fprintf(ofile, "%-*s  lines  strings  solutions  best score    seconds\n",
+          (int)name_width, "design");
+  double total_secs = 0;
+  int num_failed = 0;
+  for (unsigned int i = 0; i < designs.size(); i++) {
+    const BatchResult &res = results[i];
+    total_secs += res.secs;
+    fprintf(ofile, "%-*s  %5d  %7d  ", (int)name_width,
+            designs[i].name.c_str(), res.num_lines, res.num_strings);
+    if (!res.stat) {
+      num_failed++;
+      fprintf(ofile, "error: %s\n", res.stat.c_msg());
+    }
+    else if (res.best_score < 0)
+      fprintf(ofile, "%9d  %10s  %9.3f\n", 0, "-", res.secs);
+    else
+      fprintf(ofile, "%9d  %10d  %9.3f\n", res.num_solutions, res.best_score,
+              res.secs);
+  }
+  fprintf(ofile, "\n%d designs, %d failed, %.3f seconds of solving\n",
+          (int)designs.size(), num_failed, total_secs);
+}
@@ -0,0 +1,102 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file batch.h
+   \brief solve many designs at once, with a shared pool of workers
+*/
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "knotcolors.h"
+#include "status.h"
+#include <functional>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/// A design to solve in a batch
+struct BatchDesign {
+  std::string name;               ///< name, used for the report file
+  std::vector<std::string> lines; ///< lines of the design
+};
+
+/// Result of solving a design in a batch
+struct BatchResult {
+  Status stat;       ///< error if the design could not be solved
+  int num_lines;     ///< number of knot lines
+  int num_strings;   ///< number of strings
+  int num_solutions; ///< number of solutions found
+  int best_score;    ///< best score, or -1 if there are no solutions
+  double secs;       ///< time taken to solve
+
+  BatchResult()
+      : num_lines(0), num_strings(0), num_solutions(0), best_score(-1),
+        secs(0)
+  {
+  }
+};
+
+/// Function to write the report of a solved design
+typedef std::function<void(FILE *, const KnotColors &, const SolutionStore &)>
+    BatchReportFunction;
+
+/// Read the designs from a batch file
+/** A file may hold several designs, separated by lines starting with
+ *  \c --- , which may be followed by the name of the next design. A
+ *  design without a name is named from the file name and its position
+ *  in the file. A name may not contain \c / , and a name already used
+ *  by a design is made unique by appending \c -2 , \c -3 , ...
+ * \param fname the file name.
+ * \param designs the designs read are added to the end, with names
+ *  unique among all the designs.
+ * \return status, evaluates to \c true if the file was read. */
+Status read_batch_designs(const std::string &fname,
+                          std::vector<BatchDesign> &designs);
+
+/// Solve a batch of designs
+/** The designs are solved on a pool of worker threads, with the designs
+ *  with most knots started first. A report is written for each design to
+ *  a file in the output directory, named from the design with \c .out
+ *  appended.
+ * \param designs the designs.
+ * \param opts the options for solving each design. Only symmetric
+ *  solutions are looked for in the designs that are symmetric.
+ * \param report function writing a report.
+ * \param out_dir directory to write the reports to.
+ * \param num_threads the number of designs to solve at once, or \c 0 to
+ *  use the number of hardware threads.
+ * \return The results, in the order of the designs. */
+std::vector<BatchResult> solve_batch(const std::vector<BatchDesign> &designs,
+                                     const SolveOpts &opts,
+                                     const BatchReportFunction &report,
+                                     const std::string &out_dir,
+                                     int num_threads = 0);
+
+/// Print a summary table of the results of a batch
+/**\param ofile the file to print to.
+ * \param designs the designs.
+ * \param results the results of solving the designs. */
+void print_batch_summary(FILE *ofile, const std::vector<BatchDesign> &designs,
+                         const std::vector<BatchResult> &results);
+
+#endif // BATCH_H
@@ -0,0 +1,101 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "bracelet.h"
+#include "knotcolors.h"
+#include "pattern.h"
+
+using std::string;
+using std::vector;
+
+static BraceletSolution make_solution(const KnotColors &k, const Pattern &pat,
+                                      bool pure)
+{
+  BraceletSolution soln;
+  for (int str : pat.strings)
+    soln.strings += k.get_colour(str);
+  Pattern gen_pat = pat;
+  gen_pat.set_prefer_pure(pure); // chooses the knots of same colour strings
+  soln.knots = gen_pat.get_generator_knots(k);
+  soln.score = pat.score;
+  soln.strs_no = pat.soln_strs_no;
+  soln.perm_no = pat.soln_perm_no;
+  soln.var_no = pat.soln_var_no;
+  return soln;
+}
+
+BraceletResult bracelet_solve(const vector<string> &design,
+                              const BraceletOpts &opts,
+                              const BraceletCallbacks &callbacks,
+                              const std::atomic<bool> *cancel)
+{
+  BraceletResult result;
+  KnotColors k;
+  result.stat = k.read(design);
+  if (!result.stat)
+    return result;
+  result.num_strings = k.num_strings;
+  result.num_colours = k.num_colours;
+  if (k.num_free_strings < 0) {
+    result.stat.set_error("pattern cannot be made, the lines need more "
+                          "strings than the pattern has");
+    return result;
+  }
+
+  SolveOpts solve_opts;
+  solve_opts.prefer_pure = opts.prefer_pure;
+  solve_opts.only_symmetric = opts.only_symmetric && k.is_symmetric;
+  solve_opts.max_solutions = opts.max_solutions;
+  solve_opts.prove_optimal = opts.prove_optimal;
+  solve_opts.cancel = cancel;
+
+  BraceletProgress prog = {0, 0, "", 0};
+  if (callbacks.progress) {
+    solve_opts.progress = [&](const SolveProgress &sp) {
+      prog.strs_no = sp.strs_no;
+      prog.perm_no = sp.perm_no;
+      prog.strings.clear();
+      for (int str : sp.strings)
+        prog.strings += k.get_colour(str);
+      callbacks.progress(prog);
+    };
+    solve_opts.descents = [&](long descent_cnt) {
+      prog.descents = descent_cnt;
+      callbacks.progress(prog);
+    };
+  }
+  if (callbacks.solution)
+    solve_opts.solution = [&](const Pattern &pat) {
+      callbacks.solution(make_solution(k, pat, opts.prefer_pure));
+    };
+
+  SolutionStore solns = k.solve(solve_opts);
+  result.cancelled = cancel && *cancel;
+  result.stopped = !result.cancelled && opts.max_solutions &&
+                   !opts.prove_optimal &&
+                   (int)solns.size() >= opts.max_solutions;
+  for (size_t i = 0; i < solns.size(); i++)
+    result.solutions.push_back(
+        make_solution(k, solns.get(i), opts.prefer_pure));
+  return result;
+}
@@ -0,0 +1,119 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file bracelet.h
+   \brief library interface for solving bracelet designs
+*/
+
+#ifndef BRACELET_H
+#define BRACELET_H
+
+#include "status.h"
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+/// Options for solving a bracelet design
+struct BraceletOpts {
+  bool prefer_pure;    ///< find solution with most pure/mixed knots
+  bool only_symmetric; ///< only look for symmetric solutions, if the
+                       ///< design is symmetric
+  int max_solutions;   ///< stop adding solutions after this many (0: no limit)
+  bool prove_optimal;  ///< after max_solutions, search for better solutions
+
+  BraceletOpts()
+      : prefer_pure(true), only_symmetric(false), max_solutions(0),
+        prove_optimal(true)
+  {
+  }
+};
+
+/// A knotting solution of a bracelet design
+struct BraceletSolution {
+  std::string strings;            ///< colours of the start strings
+  std::vector<std::string> knots; ///< knots of each line, in the generator
+                                  ///< pattern format: D or d swap the
+                                  ///< strings and r or R leave them, with
+                                  ///< the colour of the left string for D
+                                  ///< and r, and of the right for d and R
+  int score;                      ///< number of knots not of the kind
+                                  ///< preferred
+  int strs_no;                    ///< reference: set of free colours
+  int perm_no;                    ///< reference: permutation of free colours
+  int var_no;                     ///< reference: knotting variation
+};
+
+/// Progress of a search
+struct BraceletProgress {
+  int strs_no;         ///< set of free colours being searched
+  int perm_no;         ///< permutation of free colours being searched
+  std::string strings; ///< colours of the start strings being searched
+  long descents;       ///< descents made by the search so far, updated
+                       ///< every 100000 descents
+};
+
+/// Functions called during a search
+struct BraceletCallbacks {
+  /// Called with each solution found. A solution may be followed by
+  /// solutions with a better score, which replace it.
+  std::function<void(const BraceletSolution &)> solution;
+  /// Called as each set of start strings is tried, and every 100000
+  /// descents of the search
+  std::function<void(const BraceletProgress &)> progress;
+};
+
+/// Result of solving a bracelet design
+struct BraceletResult {
+  Status stat;    ///< error if the design could not be solved
+  bool cancelled; ///< the search was cancelled before it finished
+  bool stopped;   ///< the search stopped at max_solutions, without
+                  ///< proving there is no better solution
+  int num_strings;                        ///< number of strings
+  int num_colours;                        ///< number of colours
+  std::vector<BraceletSolution> solutions; ///< the best solutions found
+
+  BraceletResult()
+      : cancelled(false), stopped(false), num_strings(0), num_colours(0)
+  {
+  }
+};
+
+/// Solve a bracelet design
+/** The design is given as in a design file, a line of text for each line
+ *  of knots, with a character for the colour of each knot. No output is
+ *  written, progress and solutions are only reported to the callbacks,
+ *  which are called on the thread making the search.
+ * \param design the lines of the design.
+ * \param opts the options.
+ * \param callbacks functions to call during the search, any of which
+ *  may be unset.
+ * \param cancel if not \c nullptr, the search stops soon after this is
+ *  set, returning the solutions found so far.
+ * \return The result. */
+BraceletResult bracelet_solve(const std::vector<std::string> &design,
+                              const BraceletOpts &opts,
+                              const BraceletCallbacks &callbacks =
+                                  BraceletCallbacks(),
+                              const std::atomic<bool> *cancel = nullptr);
+
+#endif // BRACELET_H
@@ -21,14 +21,26 @@
   IN THE SOFTWARE.
 */
 
+#include "anneal.h"
+#include "bands.h"
+#include "batch.h"
+#include "estimate.h"
+#include "jobserver.h"
 #include "knotcolors.h"
+#include "pareto.h"
 #include "pattern.h"
+#include "perfcounters.h"
 #include "programopts.h"
+#include "progress.h"
+#include "report.h"
+#include "resultcache.h"
+#include "solutionfile.h"
 #include "utils.h"
 
 #include <limits.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 #include <string>
 #include <vector>
 
@@ -40,14 +52,87 @@ public:
   bool prefer_pure;
   string test_strings;
   bool only_symmetric;
+  int max_solutions;
+  bool prove_optimal;
+  bool count;
+  bool histogram;
+  bool zdd;
+  int num_samples;
+  int seed;
+  bool seed_set;
+  string engine;
+  double time_limit;
+  bool pareto;
+  bool incremental;
+  string result_cache;
+  bool daemon;
+  string socket_path;
+  int num_threads;
+  bool batch;
+  string out_dir;
+  string log_level;
+  double progress_interval;
+  bool stats;
+  string stats_json;
+  string format;
+  int progress_fd;
+  bool estimate;
+  int num_probes;
+  bool bands;
+  string save_file;
+  bool render;
+  bool perf;
+  vector<string> ifiles;
   string ifile;
 
+  // identifiers for options that only have a long form
+  enum {
+    opt_first = 256,
+    opt_max_solutions,
+    opt_no_prove,
+    opt_count,
+    opt_histogram,
+    opt_zdd,
+    opt_sample,
+    opt_seed,
+    opt_engine,
+    opt_time_limit,
+    opt_pareto,
+    opt_incremental,
+    opt_result_cache,
+    opt_daemon,
+    opt_socket,
+    opt_threads,
+    opt_batch,
+    opt_output_dir,
+    opt_log_level,
+    opt_progress_interval,
+    opt_stats,
+    opt_stats_json,
+    opt_format,
+    opt_progress_fd,
+    opt_estimate,
+    opt_probes,
+    opt_bands,
+    opt_save_solutions,
+    opt_render,
+    opt_perf
+  };
+
   BrOpts()
-      : ProgramOpts("bracelet_solver"), prefer_pure(true), only_symmetric(false)
+      : ProgramOpts("bracelet_solver"), prefer_pure(true),
+        only_symmetric(false), max_solutions(0), prove_optimal(true),
+        count(false), histogram(false), zdd(false), num_samples(0), seed(0),
+        seed_set(false), engine("search"), time_limit(10), pareto(false),
+        incremental(false), daemon(false), num_threads(0),
+        batch(false), out_dir("."), log_level("info"), progress_interval(10),
+        stats(false), format("text"), progress_fd(-1), estimate(false),
+        num_probes(1000), bands(false), render(false), perf(false)
   {
   }
   void process_cmd_line(int argc, char **argv);
   void usage();
+  bool log_info() const { return log_level != "quiet"; }
 };
 
 void BrOpts::usage()
@@ -84,6 +169,113 @@ void BrOpts::usage()
       "  -m <type>  find solution with most mixed knots (default: most pure "
       "knots)\n"
       "  -s         only symmetric solutions (except middle line)\n"
+      "  -q         quiet, only print warnings and errors to standard error\n"
+      "             (same as --log-level quiet)\n"
+      "  --max-solutions <n>  only keep up to n solutions with the best score\n"
+      "  --no-prove   with --max-solutions, stop when n solutions are found,\n"
+      "             without searching for solutions with a better score\n"
+      "  --first    stop at the first solution found, whatever its score\n"
+      "             (same as --max-solutions 1 --no-prove)\n"
+      "  --count    print the number of solutions with the best score,\n"
+      "             rather than the solutions\n"
+      "  --histogram  print the number of solutions with each score,\n"
+      "             rather than the solutions\n"
+      "  --zdd      hold the solutions as a compressed decision diagram, for\n"
+      "             designs with very many solutions with the best score\n"
+      "  --sample <n>  print n solutions with the best score, chosen at\n"
+      "             random (uses --zdd)\n"
+      "  --seed <n>  seed for random choices (default: from the time)\n"
+      "  --engine <type>  method of finding solutions, type can be\n"
+      "               search - search for every solution (default)\n"
+      "               anneal - simulated annealing, finds a good solution\n"
+      "                        for designs too large to search\n"
+      "  --time-limit <secs>  time to run the anneal engine for (default: 10)\n"
+      "  --pareto   find the solutions with the most pure knots and with the\n"
+      "             most mixed knots in a single search, and the Pareto front\n"
+      "             of their scores\n"
+      "  --incremental  keep data from the search in the file\n"
+      "             bracelet_design_file.cache, and use it to search again\n"
+      "             quickly after a few lines of the design are edited\n"
+      "  --result-cache <file>  look up the design in a file of solved\n"
+      "             designs, and add it when it is solved. The design is\n"
+      "             found if its colours are relabelled, lines rotated, or\n"
+      "             it is mirrored\n"
+      "  --daemon   run as a server, reading requests to solve designs from\n"
+      "             standard input and writing the results as lines of JSON\n"
+      "             to standard output (no design file is given). Each\n"
+      "             request is 'solve <id> [options]', the design lines, and\n"
+      "             'end', where the options may be -m, -s, --first,\n"
+      "             --max-solutions=<n>, --no-prove and --priority=<n>.\n"
+      "             Other requests are 'cancel <id>', 'status', 'quit' and\n"
+      "             'shutdown'. Requests the same as a waiting or running\n"
+      "             job are joined to it. Solutions are sent as they are\n"
+      "             found, with the knots in the generator pattern format,\n"
+      "             and a solution with a better score replaces those sent\n"
+      "             before it\n"
+      "  --socket <path>  with --daemon, read requests from clients of a Unix\n"
+      "             domain socket. A client's jobs are cancelled when it\n"
+      "             disconnects\n"
+      "  --threads <n>  with --daemon or --batch, number of designs to solve\n"
+      "             at once (default: number of hardware threads)\n"
+      "  --batch    solve all the design files given, several at once. A\n"
+      "             file may hold several designs, separated by lines\n"
+      "             starting with ---, optionally followed by a name for the\n"
+      "             next design. A report is written for each design, and a\n"
+      "             summary table is printed\n"
+      "  --output-dir <dir>  with --batch, directory to write the reports to,\n"
+      "             named from the design with .out appended (default: .)\n"
+      "  --log-level <level>  messages to print to standard error, level\n"
+      "             can be\n"
+      "               quiet - only warnings and errors\n"
+      "               info  - also a line with the progress of the search\n"
+      "                       at intervals (default)\n"
+      "               debug - also every start string permutation tried,\n"
+      "                       and a dot for every 100000 search steps\n"
+      "  --progress-interval <secs>  seconds between progress lines\n"
+      "             (default: 10)\n"
+      "  --stats    print statistics of the search to standard error at the\n"
+      "             end: for each knot line the descents into the line, the\n"
+      "             knottings tried, and the knottings rejected as\n"
+      "             redundant, by the colours of the next line, by the\n"
+      "             score limit, or by not wrapping to the start strings;\n"
+      "             the descents per second, the share of permutations\n"
+      "             with no knotting of line 1, and the peak memory\n"
+      "  --stats-json <file>  write the statistics of the search to file\n"
+      "             as JSON (- for standard output)\n"
+      "  --format <fmt>  format of the report and progress lines, fmt can be\n"
+      "               text - text report and progress lines (default)\n"
+      "               json - the design, solutions and best score as a\n"
+      "                      JSON object, with the knots of each line as\n"
+      "                      in the generator pattern format, and progress\n"
+      "                      lines as JSON objects (NDJSON), ending with a\n"
+      "                      'done' event\n"
+      "  --progress-fd <n>  write the progress lines to file descriptor n\n"
+      "             (default: 2, standard error)\n"
+      "  --estimate  estimate the time the search will take, rather than\n"
+      "             searching. The start string permutations are counted,\n"
+      "             the search is run for a second to measure its speed,\n"
+      "             and the size of the search is estimated from random\n"
+      "             paths down the search tree (uses --seed), limited by\n"
+      "             the best score found by the search, or else by\n"
+      "             counting the solutions\n"
+      "  --probes <n>  with --estimate, number of random paths\n"
+      "             (default: 1000)\n"
+      "  --bands     if the design repeats across its width, search a band\n"
+      "             of the design and repeat its solutions across the\n"
+      "             width, falling back to searching the whole design if\n"
+      "             no band solution can be repeated. Faster for wide\n"
+      "             designs, but the solutions may not have the best score\n"
+      "             and not all solutions are found\n"
+      "  --save-solutions <file>  write the solutions to file in a compact\n"
+      "             binary format, rather than to the report\n"
+      "  --render    the input file is a solution file written with\n"
+      "             --save-solutions, write the report of its design and\n"
+      "             solutions (uses --format)\n"
+      "  --perf      count the processor cycles, instructions, branch\n"
+      "             misses and cache misses of the search, with Linux\n"
+      "             hardware performance counters, and print them per\n"
+      "             descent for each set of free string colours to\n"
+      "             standard error\n"
       "\n"
       "\n",
       prog_name());
@@ -92,12 +284,46 @@ void BrOpts::usage()
 void BrOpts::process_cmd_line(int argc, char **argv)
 {
   opterr = 0;
-  char c;
+  int c;
+
+  static const struct option long_opts[] = {
+      {"first", no_argument, nullptr, opt_first},
+      {"max-solutions", required_argument, nullptr, opt_max_solutions},
+      {"no-prove", no_argument, nullptr, opt_no_prove},
+      {"count", no_argument, nullptr, opt_count},
+      {"histogram", no_argument, nullptr, opt_histogram},
+      {"zdd", no_argument, nullptr, opt_zdd},
+      {"sample", required_argument, nullptr, opt_sample},
+      {"seed", required_argument, nullptr, opt_seed},
+      {"engine", required_argument, nullptr, opt_engine},
+      {"time-limit", required_argument, nullptr, opt_time_limit},
+      {"pareto", no_argument, nullptr, opt_pareto},
+      {"incremental", no_argument, nullptr, opt_incremental},
+      {"result-cache", required_argument, nullptr, opt_result_cache},
+      {"daemon", no_argument, nullptr, opt_daemon},
+      {"socket", required_argument, nullptr, opt_socket},
+      {"threads", required_argument, nullptr, opt_threads},
+      {"batch", no_argument, nullptr, opt_batch},
+      {"output-dir", required_argument, nullptr, opt_output_dir},
+      {"log-level", required_argument, nullptr, opt_log_level},
+      {"progress-interval", required_argument, nullptr,
+       opt_progress_interval},
+      {"stats", no_argument, nullptr, opt_stats},
+      {"stats-json", required_argument, nullptr, opt_stats_json},
+      {"format", required_argument, nullptr, opt_format},
+      {"progress-fd", required_argument, nullptr, opt_progress_fd},
+      {"estimate", no_argument, nullptr, opt_estimate},
+      {"probes", required_argument, nullptr, opt_probes},
+      {"bands", no_argument, nullptr, opt_bands},
+      {"save-solutions", required_argument, nullptr, opt_save_solutions},
+      {"render", no_argument, nullptr, opt_render},
+      {"perf", no_argument, nullptr, opt_perf},
+      {nullptr, 0, nullptr, 0}};
 
-  handle_long_opts(argc, argv);
+  handle_long_opts(argc, argv, long_opts);
 
-  while ((c = getopt(argc, argv, ":hvms")) != -1) {
-    if (common_opts(c, optopt))
+  while ((c = getopt_long(argc, argv, ":hvmsq", long_opts, nullptr)) != -1) {
+    if (c < opt_first && common_opts(c, optopt))
       continue;
 
     switch (c) {
@@ -109,23 +335,308 @@ void BrOpts::process_cmd_line(int argc, char **argv)
       only_symmetric = true;
       break;
 
+    case 'q':
+      log_level = "quiet";
+      break;
+
+    case opt_first:
+      max_solutions = 1;
+      prove_optimal = false;
+      break;
+
+    case opt_max_solutions:
+      print_status_or_exit(read_int(optarg, &max_solutions), "max-solutions");
+      if (max_solutions < 1)
+        error("number of solutions must be 1 or more", "max-solutions");
+      break;
+
+    case opt_no_prove:
+      prove_optimal = false;
+      break;
+
+    case opt_count:
+      count = true;
+      break;
+
+    case opt_histogram:
+      count = true;
+      histogram = true;
+      break;
+
+    case opt_zdd:
+      zdd = true;
+      break;
+
+    case opt_sample:
+      print_status_or_exit(read_int(optarg, &num_samples), "sample");
+      if (num_samples < 1)
+        error("number of samples must be 1 or more", "sample");
+      zdd = true;
+      break;
+
+    case opt_seed:
+      print_status_or_exit(read_int(optarg, &seed), "seed");
+      seed_set = true;
+      break;
+
+    case opt_engine:
+      print_status_or_exit(
+          get_arg_id(optarg, &engine, "search=search|anneal=anneal"),
+          "engine");
+      break;
+
+    case opt_pareto:
+      pareto = true;
+      break;
+
+    case opt_incremental:
+      incremental = true;
+      break;
+
+    case opt_result_cache:
+      result_cache = optarg;
+      break;
+
+    case opt_daemon:
+      daemon = true;
+      break;
+
+    case opt_socket:
+      socket_path = optarg;
+      break;
+
+    case opt_threads:
+      print_status_or_exit(read_int(optarg, &num_threads), "threads");
+      if (num_threads < 1)
+        error("number of threads must be 1 or more", "threads");
+      break;
+
+    case opt_batch:
+      batch = true;
+      break;
+
+    case opt_output_dir:
+      out_dir = optarg;
+      break;
+
+    case opt_log_level:
+      print_status_or_exit(
+          get_arg_id(optarg, &log_level, "quiet=quiet|info=info|debug=debug"),
+          "log-level");
+      break;
+
+    case opt_progress_interval:
+      print_status_or_exit(read_double(optarg, &progress_interval),
+                           "progress-interval");
+      if (progress_interval <= 0)
+        error("interval must be greater than 0", "progress-interval");
+      break;
+
+    case opt_stats:
+      stats = true;
+      break;
+
+    case opt_stats_json:
+      stats_json = optarg;
+      break;
+
+    case opt_format:
+      print_status_or_exit(
+          get_arg_id(optarg, &format, "text=text|json=json"), "format");
+      break;
+
+    case opt_progress_fd:
+      print_status_or_exit(read_int(optarg, &progress_fd), "progress-fd");
+      if (progress_fd < 0)
+        error("file descriptor cannot be negative", "progress-fd");
+      break;
+
+    case opt_estimate:
+      estimate = true;
+      break;
+
+    case opt_probes:
+      print_status_or_exit(read_int(optarg, &num_probes), "probes");
+      if (num_probes < 1)
+        error("number of probes must be 1 or more", "probes");
+      break;
+
+    case opt_bands:
+      bands = true;
+      break;
+
+    case opt_save_solutions:
+      save_file = optarg;
+      break;
+
+    case opt_render:
+      render = true;
+      break;
+
+    case opt_perf:
+      perf = true;
+      break;
+
+    case opt_time_limit:
+      print_status_or_exit(read_double(optarg, &time_limit), "time-limit");
+      if (time_limit < 0)
+        error("time cannot be negative", "time-limit");
+      break;
+
     default:
       error("unknown command line error");
     }
   }
 
   int num_args = argc - optind;
+  if ((daemon || batch) && (stats || stats_json != ""))
+    error("cannot be used with --daemon or --batch",
+          stats ? "stats" : "stats-json");
+  if ((daemon || batch) && format != "text")
+    error("cannot be used with --daemon or --batch", "format");
+  if ((daemon || batch) && progress_fd >= 0)
+    error("cannot be used with --daemon or --batch", "progress-fd");
+  if ((daemon || batch) && estimate)
+    error("cannot be used with --daemon or --batch", "estimate");
+  if ((daemon || batch) && bands)
+    error("cannot be used with --daemon or --batch", "bands");
+  if ((daemon || batch) && (save_file != "" || render))
+    error("cannot be used with --daemon or --batch",
+          render ? "render" : "save-solutions");
+  if ((daemon || batch) && perf)
+    error("cannot be used with --daemon or --batch", "perf");
+  if (daemon) {
+    if (num_args)
+      error("a design file cannot be given, designs are sent as requests",
+            "daemon");
+    return;
+  }
+  if (socket_path != "")
+    error("only valid with --daemon", "socket");
+  if (batch) {
+    if (num_args == 0)
+      error("no design files specified", "batch");
+    if (count || zdd || pareto || incremental || result_cache != "" ||
+        engine != "search")
+      error("cannot be used with --count, --histogram, --zdd, --sample, "
+            "--pareto, --incremental, --result-cache or --engine",
+            "batch");
+    ifiles.assign(argv + optind, argv + argc);
+    return;
+  }
+  if (num_threads)
+    error("only valid with --daemon or --batch", "threads");
   if (num_args != 1)
     error(msg_str("%s knot colour file specified",
                   (num_args == 0) ? "no" : "more than one"),
           "bracelet_design_file");
 
+  if (!prove_optimal && !max_solutions)
+    error("only valid with --max-solutions", "no-prove");
+
+  if (count && max_solutions)
+    error("cannot be used with --max-solutions or --first",
+          histogram ? "histogram" : "count");
+
+  if (zdd && (count || max_solutions))
+    error("cannot be used with --count, --histogram, --max-solutions or "
+          "--first",
+          num_samples ? "sample" : "zdd");
+
+  if (engine == "anneal" && (count || zdd || max_solutions))
+    error("anneal engine cannot be used with --count, --histogram, --zdd, "
+          "--sample, --max-solutions or --first",
+          "engine");
+
+  if (pareto && (count || zdd || max_solutions || engine != "search"))
+    error("cannot be used with --count, --histogram, --zdd, --sample, "
+          "--max-solutions, --first or --engine",
+          "pareto");
+
+  if (pareto && only_symmetric)
+    error("cannot be used with -s", "pareto");
+
+  if (incremental && (count || zdd || pareto || engine != "search"))
+    error("cannot be used with --count, --histogram, --zdd, --sample, "
+          "--pareto or --engine",
+          "incremental");
+
+  if (result_cache != "" &&
+      (count || zdd || pareto || max_solutions || engine != "search"))
+    error("cannot be used with --count, --histogram, --zdd, --sample, "
+          "--pareto, --max-solutions, --first or --engine",
+          "result-cache");
+
+  if ((stats || stats_json != "") &&
+      (count || zdd || pareto || engine != "search"))
+    error("cannot be used with --count, --histogram, --zdd, --sample, "
+          "--pareto or --engine",
+          stats ? "stats" : "stats-json");
+
+  if (format == "json" && (count || zdd || pareto || engine != "search"))
+    error("cannot be used with --count, --histogram, --zdd, --sample, "
+          "--pareto or --engine",
+          "format");
+
+  if (estimate && (count || zdd || pareto || max_solutions || incremental ||
+                   result_cache != "" || stats || stats_json != "" ||
+                   engine != "search"))
+    error("cannot be used with --count, --histogram, --zdd, --sample, "
+          "--pareto, --max-solutions, --first, --incremental, "
+          "--result-cache, --stats, --stats-json or --engine",
+          "estimate");
+
+  if (bands && (count || zdd || pareto || incremental || result_cache != "" ||
+                estimate || engine != "search"))
+    error("cannot be used with --count, --histogram, --zdd, --sample, "
+          "--pareto, --incremental, --result-cache, --estimate or --engine",
+          "bands");
+
+  if (save_file != "" && (count || zdd || pareto || estimate ||
+                          format == "json" || engine != "search"))
+    error("cannot be used with --count, --histogram, --zdd, --sample, "
+          "--pareto, --estimate, --format json or --engine",
+          "save-solutions");
+
+  if (render && (count || zdd || pareto || estimate || bands ||
+                 save_file != "" || incremental || result_cache != "" ||
+                 stats || stats_json != "" || engine != "search"))
+    error("cannot be used with --count, --histogram, --zdd, --sample, "
+          "--pareto, --estimate, --bands, --save-solutions, --incremental, "
+          "--result-cache, --stats, --stats-json or --engine",
+          "render");
+
+  if (perf && (count || zdd || pareto || estimate || bands || render ||
+               engine != "search"))
+    error("cannot be used with --count, --histogram, --zdd, --sample, "
+          "--pareto, --estimate, --bands, --render or --engine",
+          "perf");
+
+  if (format == "json" && stats_json == "-")
+    error("cannot write to standard output with --format json",
+          "stats-json");
+
+  if (!seed_set)
+    seed = (int)time(nullptr);
+
   ifile = argv[optind];
+  if (incremental && (ifile == "" || ifile == "-"))
+    error("cannot be used when reading the design from standard input",
+          "incremental");
 }
 
-Status print_header(const KnotColors &k, string prog_name)
+const char free_strings_msg[] =
+    "pattern cannot be made.\n"
+    "The number of knots of each colour in a line puts a limit on the "
+    "minimum\n"
+    "number strings of that colour required, and the total number of "
+    "required\n"
+    "strings exceeds the number of strings in the proposed pattern.";
+
+Status print_header(const KnotColors &k, string prog_name,
+                    FILE *ofile = stdout)
 {
-  fprintf(stdout,
+  fprintf(ofile,
           "The following knotting solutions were found by\n"
           "\n"
           "   %s\n"
@@ -136,50 +647,290 @@ Status print_header(const KnotColors &k, string prog_name)
           "\n",
           prog_name.c_str());
 
-  fprintf(stdout, "Knot pattern to solve:\n");
-  k.print_knots(stdout);
-  fprintf(stdout, "\n");
+  fprintf(ofile, "Knot pattern to solve:\n");
+  k.print_knots(ofile);
+  fprintf(ofile, "\n");
 
-  fprintf(stdout, "Number of colours: %3d\n", k.num_colours);
-  fprintf(stdout, "Number of strings: %3d\n", k.num_strings);
+  fprintf(ofile, "Number of colours: %3d\n", k.num_colours);
+  fprintf(ofile, "Number of strings: %3d\n", k.num_strings);
   // The number of knots of each colour in a line puts a limit on the minimum
   // number strings of that colour required. The total number of required
   // strings is subtracted from the number of strings in the pattern to give
   // the number of free strings. The free strings can be assigned various
   // combinations of colours, then combined with the required strings and
   // used to search for solutions.
-  //   fprintf(stdout, "Number of free strings: %3d\n", k.num_free_strings);
+  //   fprintf(ofile, "Number of free strings: %3d\n", k.num_free_strings);
 
-  fprintf(stdout, "\n");
+  fprintf(ofile, "\n");
 
-  print_cnts(stdout, k.req_colour_cnts, k, "Required string colour counts");
+  print_cnts(ofile, k.req_colour_cnts, k, "Required string colour counts");
 
-  const char free_strings_msg[] =
-      "pattern cannot be made.\n"
-      "The number of knots of each colour in a line puts a limit on the "
-      "minimum\n"
-      "number strings of that colour required, and the total number of "
-      "required\n"
-      "strings exceeds the number of strings in the proposed pattern.";
   if (k.num_free_strings < 0) {
-    fprintf(stdout, "\n%s\n\n", free_strings_msg);
+    fprintf(ofile, "\n%s\n\n", free_strings_msg);
     return Status::error(free_strings_msg);
   }
 
   return Status::ok();
 }
 
-void print_solutions(const vector<Pattern> &solns, const KnotColors &k)
+// Print the start strings being tried, and the free string colour counts
+// when they change
+void print_progress(const KnotColors &k, const SolveProgress &prog,
+                    FILE *ofile = stderr)
+{
+  if (prog.perm_no == 0) {
+    fprintf(ofile, "\n================================\n");
+    print_cnts(ofile, prog.free_strings, k, "Free string colour counts");
+  }
+  for (int str : prog.strings)
+    fprintf(ofile, "%c ", k.get_colour(str));
+  fprintf(ofile, "\n");
+}
+
+// Print a dot for every 100000 descents of the search
+void print_descents(long descent_cnt, FILE *ofile = stderr)
 {
-  int sol_no = 0;
-  for (const auto &pat : solns)
-    pat.print_pattern(k, sol_no++, stdout);
+  fprintf(ofile, ".");
+  if (descent_cnt % 1000000 == 0)
+    fprintf(ofile, " ");
+  if (descent_cnt % 7000000 == 0)
+    fprintf(ofile, "\n");
+  fflush(ofile);
+}
+
+void print_solutions(const SolutionStore &solns, const KnotColors &k,
+                     FILE *ofile = stdout)
+{
+  ReportRenderer renderer(k, ofile);
+  renderer.render_all(solns);
+}
+
+// Print the design, and the solutions or an error, as a JSON object
+void print_json_report(const KnotColors &k, const string &prog_name,
+                       const SolutionStore &solns, const Status &stat,
+                       FILE *ofile = stdout)
+{
+  string lines;
+  for (size_t i = 0; i < k.knots.size(); i++) {
+    string line;
+    for (int knot : k.knots[i])
+      line += k.get_colour(knot);
+    lines += (i ? "," : "") + json_str(line);
+  }
+  string req_cnts;
+  for (int i = 0; i < k.num_colours; i++)
+    req_cnts += msg_str("%s\"%c\":%d", i ? "," : "", k.get_colour(i),
+                        k.req_colour_cnts[i]);
+  fprintf(ofile,
+          "{\"program\":%s,\"design\":{\"lines\":[%s],\"colours\":%d,"
+          "\"strings\":%d,\"required_counts\":{%s}},",
+          json_str(prog_name).c_str(), lines.c_str(), k.num_colours,
+          k.num_strings, req_cnts.c_str());
+  if (!stat) {
+    fprintf(ofile, "\"status\":\"error\",\"message\":%s}\n",
+            json_str(stat.msg()).c_str());
+    return;
+  }
+
+  fprintf(ofile, "\"status\":\"ok\",\"best_score\":%s,\"solutions\":[",
+          solns.size() ? msg_str("%d", solns.score(0)).c_str() : "null");
+  for (size_t i = 0; i < solns.size(); i++) {
+    const Pattern pat = solns.get(i);
+    string strings;
+    for (int str : pat.strings)
+      strings += k.get_colour(str);
+    string knots;
+    for (const auto &knot_types : pat.get_generator_knots(k))
+      knots += (knots.empty() ? "" : ",") + json_str(knot_types);
+    fprintf(ofile,
+            "%s{\"index\":%d,\"score\":%d,\"ref\":\"%d/%d/%d\","
+            "\"strings\":%s,\"knots\":[%s]}",
+            i ? "," : "", (int)i, pat.score, pat.soln_strs_no,
+            pat.soln_perm_no, pat.soln_var_no, json_str(strings).c_str(),
+            knots.c_str());
+  }
+  fprintf(ofile, "]}\n");
+}
+
+// Write the solutions to a binary solution file, and report where they are
+Status save_solutions(const SolutionStore &solns, const KnotColors &k,
+                      FILE *sfile, const string &fname, FILE *ofile = stdout)
+{
+  Status stat = write_solution_file(sfile, k, solns);
+  if (fclose(sfile) != 0 && stat)
+    stat.set_error("could not write solution file");
+  if (stat)
+    fprintf(ofile, "\n-------------------------------------------\n"
+                   "%lu solutions written to solution file '%s'\n",
+            (unsigned long)solns.size(), fname.c_str());
+  return stat;
+}
+
+// Print the report of a binary solution file
+Status render_solution_file(const string &fname, const string &prog_name,
+                            const string &format)
+{
+  FILE *sfile =
+      (fname == "" || fname == "-") ? stdin : fopen(fname.c_str(), "rb");
+  if (!sfile)
+    return Status::error(
+        msg_str("could not open solution file '%s'", fname.c_str()));
+  KnotColors k;
+  SolutionStore solns;
+  Status stat = read_solution_file(sfile, k, solns);
+  if (sfile != stdin)
+    fclose(sfile);
+  if (!stat)
+    return Status::error(msg_str("solution file '%s': %s", fname.c_str(),
+                                 stat.c_msg()));
+
+  if (format == "json")
+    print_json_report(k, prog_name, solns, Status::ok());
+  else if (print_header(k, prog_name))
+    print_solutions(solns, k);
+  return Status::ok();
+}
+
+void print_counts(const ScoreCounts &cnts, bool histogram)
+{
+  fprintf(stdout, "\n-------------------------------------------\n");
+  if (cnts.empty()) {
+    fprintf(stdout, "No solutions found\n");
+    return;
+  }
+
+  if (histogram) {
+    fprintf(stdout, "Number of solutions by score:\n\n"
+                    "   score  solutions\n");
+    for (const auto &kp : cnts.get_counts())
+      fprintf(stdout, "   %5d  %s\n", kp.first, kp.second.to_string().c_str());
+  }
+  else {
+    const auto &best = *cnts.get_counts().begin();
+    fprintf(stdout, "Best score: %d\n", best.first);
+    fprintf(stdout, "Number of solutions: %s\n",
+            best.second.to_string().c_str());
+  }
+  fprintf(stdout, "\n");
+}
+
+void print_zdd_solutions(const ZddStore &store, const KnotColors &k,
+                         int num_samples, int seed, bool verbose)
+{
+  if (verbose)
+    fprintf(stderr, "\nsolutions held in %lu diagram nodes\n",
+            (unsigned long)store.num_nodes());
+  fprintf(stdout, "Number of solutions: %s\n",
+          store.count().to_string().c_str());
+  Pattern pat;
+  if (num_samples) {
+    fprintf(stdout, "Random sample of solutions (seed: %d)\n", seed);
+    std::mt19937_64 rng(seed);
+    for (int i = 0; i < num_samples && store.sample(rng, pat); i++)
+      pat.print_pattern(k, i, stdout);
+  }
+  else {
+    ZddStore::Enumerator solns(store);
+    for (int i = 0; solns.next(pat); i++)
+      pat.print_pattern(k, i, stdout);
+  }
+}
+
+void print_anneal_solution(const KnotColors &k, const SolveOpts &opts,
+                           int seed, double time_limit, bool verbose)
+{
+  AnnealSearch search(k, opts.prefer_pure, opts.only_symmetric, seed);
+  Pattern pat;
+  AnnealRoundFunction round;
+  if (verbose)
+    round = [](int round_no, int best_score) {
+      if (best_score >= 0)
+        fprintf(stderr, "round %d: best score %d\n", round_no, best_score);
+      else
+        fprintf(stderr, "round %d: no solution\n", round_no);
+    };
+  const bool found = search.run(time_limit, pat, round);
+  fprintf(stdout, "Best solution found by simulated annealing (seed: %d, "
+                  "rounds: %d)\n",
+          seed, search.rounds);
+  if (found)
+    pat.print_pattern(k, 0, stdout);
+  else
+    fprintf(stdout, "\nNo solutions found\n");
+}
+
+void print_pareto_solutions(const KnotColors &k, const SolveOpts &opts,
+                            ProgressReporter &reporter)
+{
+  ParetoSearch search(k);
+  search.set_descent_function(opts.descents ? &opts.descents : nullptr);
+  k.for_each_start_strings(
+      [&](const vector<int> &strings, int strs_no, int perm_no) {
+        search.add_strings(strings, strs_no, perm_no);
+      },
+      opts.progress);
+  reporter.stop();
+
+  fprintf(stdout, "\n-------------------------------------------\n");
+  if (search.get_front().empty()) {
+    fprintf(stdout, "No solutions found\n");
+    return;
+  }
+
+  fprintf(stdout, "Pareto front of pure and mixed scores:\n\n"
+                  "   pure  mixed\n");
+  for (const auto &pt : search.get_front())
+    fprintf(stdout, "   %4d   %4d\n", pt.pure_score, pt.mixed_score);
+
+  fprintf(stdout, "\n===========================================\n"
+                  "Solutions with most pure knots\n");
+  print_solutions(search.get_pure_solutions(), k);
+  fprintf(stdout, "\n===========================================\n"
+                  "Solutions with most mixed knots\n");
+  print_solutions(search.get_mixed_solutions(), k);
 }
 
 int main(int argc, char **argv)
 {
   BrOpts opts;
   opts.process_cmd_line(argc, argv);
+
+  if (opts.batch) {
+    vector<BatchDesign> designs;
+    for (const auto &fname : opts.ifiles)
+      opts.print_status_or_exit(read_batch_designs(fname, designs));
+    SolveOpts solve_opts;
+    solve_opts.prefer_pure = opts.prefer_pure;
+    solve_opts.only_symmetric = opts.only_symmetric;
+    solve_opts.max_solutions = opts.max_solutions;
+    solve_opts.prove_optimal = opts.prove_optimal;
+    const string prog_name = opts.prog_name();
+    auto report = [&prog_name](FILE *ofile, const KnotColors &k,
+                               const SolutionStore &solns) {
+      if (print_header(k, prog_name, ofile))
+        print_solutions(solns, k, ofile);
+    };
+    vector<BatchResult> results = solve_batch(designs, solve_opts, report,
+                                              opts.out_dir, opts.num_threads);
+    print_batch_summary(stdout, designs, results);
+    return 0;
+  }
+
+  if (opts.daemon) {
+    JobServer server(opts.num_threads);
+    if (opts.socket_path != "")
+      opts.print_status_or_exit(server.serve_socket(opts.socket_path),
+                                "socket");
+    else
+      server.serve_stream(stdin, stdout);
+    return 0;
+  }
+  if (opts.render) {
+    opts.print_status_or_exit(
+        render_solution_file(opts.ifile, opts.prog_name(), opts.format));
+    return 0;
+  }
+
   FILE *file;
   if (opts.ifile == "" || opts.ifile == "-")
     file = stdin;
@@ -198,9 +949,232 @@ int main(int argc, char **argv)
     only_symmetric = false;
   }
 
-  opts.print_status_or_exit(print_header(k, opts.prog_name()));
-  vector<Pattern> solns = k.solve(opts.prefer_pure, false);
-  print_solutions(solns, k);
+  const bool json = opts.format == "json";
+  if (!json)
+    opts.print_status_or_exit(print_header(k, opts.prog_name()));
+  else if (k.num_free_strings < 0) {
+    Status stat = Status::error(free_strings_msg);
+    print_json_report(k, opts.prog_name(), SolutionStore(), stat);
+    opts.print_status_or_exit(stat);
+  }
+
+  // opened before the search, so that it doesn't fail after it
+  FILE *save_file = nullptr;
+  if (opts.save_file != "" &&
+      !(save_file = fopen(opts.save_file.c_str(), "wb")))
+    opts.error(
+        msg_str("could not open solution file '%s'", opts.save_file.c_str()),
+        "save-solutions");
+
+  FILE *progress_file = stderr;
+  if (opts.progress_fd >= 0 && opts.progress_fd != 2 &&
+      !(progress_file = fdopen(opts.progress_fd, "w")))
+    opts.error(msg_str("could not write to file descriptor %d",
+                       opts.progress_fd),
+               "progress-fd");
+
+  SolveOpts solve_opts;
+  solve_opts.prefer_pure = opts.prefer_pure;
+  solve_opts.only_symmetric = only_symmetric;
+  solve_opts.max_solutions = opts.max_solutions;
+  solve_opts.prove_optimal = opts.prove_optimal;
+  if (opts.estimate) {
+    const double calibrate_secs = 1;
+    if (opts.log_info())
+      fprintf(stderr, "running the search for %g second to measure its "
+                      "speed\n",
+              calibrate_secs);
+    SearchEstimate est;
+    est.estimate(k, solve_opts, opts.num_probes, calibrate_secs, opts.seed);
+    if (json)
+      est.print_json(stdout);
+    else
+      est.print(stdout);
+    return 0;
+  }
+
+  ProgressReporter reporter(opts.progress_interval, progress_file, json);
+  if (opts.log_level == "debug") {
+    solve_opts.progress = [&k, progress_file](const SolveProgress &prog) {
+      print_progress(k, prog, progress_file);
+    };
+    solve_opts.descents = [progress_file](long descent_cnt) {
+      print_descents(descent_cnt, progress_file);
+    };
+  }
+  else if (opts.log_level == "info" && opts.engine == "search") {
+    reporter.set_callbacks(solve_opts, k);
+    reporter.start();
+  }
+
+  if (opts.count) {
+    ScoreCounts cnts = k.count(solve_opts, opts.histogram);
+    reporter.stop();
+    print_counts(cnts, opts.histogram);
+    return 0;
+  }
+
+  if (opts.engine == "anneal") {
+    print_anneal_solution(k, solve_opts, opts.seed, opts.time_limit,
+                          opts.log_info());
+    return 0;
+  }
+
+  if (opts.pareto) {
+    print_pareto_solutions(k, solve_opts, reporter);
+    return 0;
+  }
+
+  if (opts.zdd) {
+    ZddStore store;
+    k.solve_zdd(solve_opts, store);
+    reporter.stop();
+    print_zdd_solutions(store, k, opts.num_samples, opts.seed,
+                        opts.log_info());
+    return 0;
+  }
+
+  ResultCache results;
+  if (opts.result_cache != "") {
+    if (FILE *rfile = fopen(opts.result_cache.c_str(), "r")) {
+      Status stat = results.read(rfile);
+      fclose(rfile);
+      if (!stat)
+        opts.error(msg_str("results file '%s': %s",
+                           opts.result_cache.c_str(), stat.c_msg()),
+                   "result-cache");
+    }
+    SolutionStore solns;
+    if (results.find(k, opts.prefer_pure, only_symmetric, solns)) {
+      reporter.stop();
+      if (opts.log_info())
+        fprintf(stderr, "design found in results file\n");
+      if (json)
+        print_json_report(k, opts.prog_name(), solns, Status::ok());
+      else if (opts.save_file != "")
+        opts.print_status_or_exit(
+            save_solutions(solns, k, save_file, opts.save_file));
+      else
+        print_solutions(solns, k);
+      return 0;
+    }
+  }
+
+  SolveCache cache;
+  string cache_file = opts.ifile + ".cache";
+  if (opts.incremental) {
+    if (FILE *cfile = fopen(cache_file.c_str(), "r")) {
+      Status stat = cache.read(cfile);
+      fclose(cfile);
+      if (!stat)
+        opts.warning(msg_str("cache file '%s' not used: %s",
+                             cache_file.c_str(), stat.c_msg()),
+                     "incremental");
+    }
+    cache.set_design(k, only_symmetric);
+    solve_opts.cache = &cache;
+  }
+
+  SearchStats stats;
+  if (opts.stats || opts.stats_json != "")
+    solve_opts.stats = &stats;
+
+  // the descents reported during the search are only updated every
+  // 100000 descents
+  long descents = 0;
+  solve_opts.descent_total = &descents;
+
+  PerfProfile perf;
+  bool perf_started = false;
+  if (opts.perf) {
+    Status stat = perf.start();
+    if (stat.is_error())
+      opts.warning(msg_str("%s, not counting", stat.c_msg()), "perf");
+    else {
+      if (stat.is_warning())
+        opts.warning(stat.msg(), "perf");
+      // a block for each set of free string colours
+      ProgressFunction progress = solve_opts.progress;
+      solve_opts.progress = [&k, &perf, progress](const SolveProgress &prog) {
+        if (prog.perm_no == 0) {
+          string free_cols;
+          for (int i = 0; i < k.num_colours; i++)
+            free_cols += string(prog.free_strings[i], k.get_colour(i));
+          perf.start_block(free_cols.empty() ? "none" : free_cols,
+                           prog.descents);
+        }
+        if (progress)
+          progress(prog);
+      };
+      perf_started = true;
+    }
+  }
+
+  SolutionStore solns;
+  bool solved = false;
+  if (opts.bands) {
+    if (int band_knots = get_band_knots(k)) {
+      if (opts.log_info())
+        fprintf(stderr, "design repeats across its width, searching a band "
+                        "of %d knots\n",
+                band_knots);
+      solved = solve_bands(k, band_knots, solve_opts, solns);
+      if (!solved && opts.log_info())
+        fprintf(stderr, "no band solution repeats across the width, "
+                        "searching the whole design\n");
+    }
+    else if (opts.log_info())
+      fprintf(stderr, "design does not repeat across its width\n");
+  }
+  if (!solved)
+    solns = k.solve(solve_opts);
+  reporter.stop(descents);
+  if (perf_started) {
+    perf.stop(descents);
+    perf.print(stderr);
+  }
+  if (json)
+    print_json_report(k, opts.prog_name(), solns, Status::ok());
+  else if (opts.save_file != "")
+    opts.print_status_or_exit(
+        save_solutions(solns, k, save_file, opts.save_file));
+  else
+    print_solutions(solns, k);
+
+  if (opts.stats)
+    stats.print(stderr);
+  if (opts.stats_json == "-")
+    stats.print_json(stdout);
+  else if (opts.stats_json != "") {
+    FILE *sfile = fopen(opts.stats_json.c_str(), "w");
+    if (sfile) {
+      stats.print_json(sfile);
+      fclose(sfile);
+    }
+    else
+      opts.warning(msg_str("could not write statistics file '%s'",
+                           opts.stats_json.c_str()),
+                   "stats-json");
+  }
+
+  if (opts.result_cache != "") {
+    results.add(k, opts.prefer_pure, only_symmetric, solns);
+    Status stat = replace_file(
+        opts.result_cache, [&](FILE *rfile) { results.write(rfile); });
+    if (!stat)
+      opts.warning(msg_str("could not write results file '%s': %s",
+                           opts.result_cache.c_str(), stat.c_msg()),
+                   "result-cache");
+  }
+
+  if (opts.incremental) {
+    Status stat =
+        replace_file(cache_file, [&](FILE *cfile) { cache.write(cfile); });
+    if (!stat)
+      opts.warning(msg_str("could not write cache file '%s': %s",
+                           cache_file.c_str(), stat.c_msg()),
+                   "incremental");
+  }
 
   return 0;
 }
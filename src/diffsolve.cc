@@ -0,0 +1,435 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file diffsolve.cc
+   \brief solve generated designs with two engines and compare the results
+*/
+
+#include "knotcolors.h"
+#include "pattern.h"
+#include "pattext.h"
+#include "programopts.h"
+#include "solutioncount.h"
+#include "utils.h"
+#include "verify.h"
+#include "zddstore.h"
+#include <algorithm>
+#include <chrono>
+#include <limits.h>
+#include <map>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+class DiffOpts : public ProgramOpts {
+public:
+  vector<string> engines;
+  int num_designs;
+  int width;
+  int height;
+  int colours;
+  double swap_prob;
+  int seed;
+  bool prefer_pure;
+
+  DiffOpts()
+      : ProgramOpts("diffsolve"), engines({"search", "recursive"}),
+        num_designs(100), width(8), height(8), colours(3), swap_prob(0.5),
+        seed(1), prefer_pure(true)
+  {
+  }
+  void process_cmd_line(int argc, char **argv);
+  void usage();
+};
+
+void DiffOpts::usage()
+{
+  fprintf(stdout,
+          "\n"
+          "Usage: %s [options]\n"
+          "\n"
+          "Solve generated designs with two engines, check every solution\n"
+          "found by replaying it, and compare the best scores and the sets\n"
+          "of solutions of the engines. Design i is made with seed+i, and\n"
+          "is the design made by gen_design with the same options. Any\n"
+          "difference is reported, and the exit status is 1.\n"
+          "\n"
+          "Options\n"
+          "  -h         print this help text\n"
+          "  -v         print the program version and licence\n"
+          "  -e <engs>  two engines to compare, separated by a comma, or one\n"
+          "             engine to only check its solutions. The engines are\n"
+          "               search - the search of bracelet_solver (default)\n"
+          "               generic - the search without the specialised\n"
+          "                         searches for numbers of strings\n"
+          "               recursive - the reference recursive search\n"
+          "                         (default)\n"
+          "               zdd - the decision diagram store\n"
+          "               count - the solution counter, compares only the\n"
+          "                       score and number of solutions\n"
+          "               histogram - the solution counter for every score,\n"
+          "                       checked against counting the knottings\n"
+          "                       of every score one by one\n"
+          "  -n <n>     number of designs (default: 100)\n"
+          "  -m         find solutions with most mixed knots (default: most\n"
+          "             pure knots)\n"
+          "  -w <n>     number of strings (default: 8)\n"
+          "  -l <n>     number of knot lines, must be even (default: 8)\n"
+          "  -c <n>     number of colours, from 1 to 26 (default: 3)\n"
+          "  -p <prob>  probability that a random knot swaps its strings\n"
+          "             (default: 0.5)\n"
+          "  -s <n>     seed of the first design (default: 1)\n"
+          "\n",
+          prog_name());
+}
+
+void DiffOpts::process_cmd_line(int argc, char **argv)
+{
+  opterr = 0;
+  int c;
+
+  handle_long_opts(argc, argv);
+
+  while ((c = getopt(argc, argv, ":hve:n:mw:l:c:p:s:")) != -1) {
+    if (common_opts(c, optopt))
+      continue;
+
+    switch (c) {
+    case 'e': {
+      engines.clear();
+      vector<char *> parts;
+      split_line(optarg, parts, ",");
+      if (parts.size() < 1 || parts.size() > 2)
+        error("give one or two engines", c);
+      for (char *part : parts) {
+        string engine;
+        print_status_or_exit(
+            get_arg_id(part, &engine, "search=search|generic=generic|"
+                                      "recursive=recursive|zdd=zdd|"
+                                      "count=count|histogram=histogram"),
+            c);
+        engines.push_back(engine);
+      }
+      if (engines[0] == "count" && engines.size() == 1)
+        error("count engine has no solutions to check", c);
+      break;
+    }
+
+    case 'n':
+      print_status_or_exit(read_int(optarg, &num_designs), c);
+      if (num_designs < 1)
+        error("number of designs must be 1 or more", c);
+      break;
+
+    case 'm':
+      prefer_pure = false;
+      break;
+
+    case 'w':
+      print_status_or_exit(read_int(optarg, &width), c);
+      if (width < 3)
+        error("number of strings must be 3 or more", c);
+      break;
+
+    case 'l':
+      print_status_or_exit(read_int(optarg, &height), c);
+      if (height < 2 || height % 2)
+        error("number of knot lines must be even, and 2 or more", c);
+      break;
+
+    case 'c':
+      print_status_or_exit(read_int(optarg, &colours), c);
+      if (colours < 1 || colours > 26)
+        error("number of colours must be from 1 to 26", c);
+      break;
+
+    case 'p':
+      print_status_or_exit(read_double(optarg, &swap_prob), c);
+      if (swap_prob < 0 || swap_prob > 1)
+        error("probability must be from 0 to 1", c);
+      break;
+
+    case 's':
+      print_status_or_exit(read_int(optarg, &seed), c);
+      break;
+
+    default:
+      error("unknown command line error");
+    }
+  }
+
+  if (argc - optind > 0)
+    error("too many arguments");
+
+  if (colours > width)
+    error(msg_str("number of colours is greater than the number of "
+                  "strings (%d)",
+                  width),
+          'c');
+}
+
+// Solutions found by an engine
+struct EngineResult {
+  int score;           // best score, INT_MAX if there are no solutions
+  uint64_t count;      // number of solutions
+  bool has_sols;       // the solutions were made, not only counted
+  vector<string> sols; // text of each solution, sorted
+  string fault;        // the first solution that failed the check
+  long checked;        // number of solutions checked
+  double check_secs;   // time spent checking solutions
+};
+
+// Text of a solution, the start strings then the knots of each line
+string solution_text(const KnotColors &k, const Pattern &pat)
+{
+  string txt;
+  for (int str : pat.strings)
+    txt += k.get_colour(str);
+  for (const auto &knots_line : pat.knots) {
+    txt += ' ';
+    for (int knot : knots_line)
+      txt += knot ? '1' : '0';
+  }
+  return txt;
+}
+
+// Record the check of a solution, and the first fault
+void record_check(const Status &stat, int sol_no, EngineResult &res)
+{
+  if (stat.is_error() && res.fault == "")
+    res.fault = msg_str("solution %d: %s", sol_no, stat.c_msg());
+  res.checked++;
+}
+
+// Count the solutions of every score by trying every knotting of each line
+void count_all_knottings(const KnotColors &k, int line,
+                         const vector<int> &strings_in,
+                         const vector<int> &start, bool pure, int score,
+                         std::map<int, uint64_t> &cnts)
+{
+  const int first = line % 2;
+  const int next_line = (line < (int)k.knots.size() - 1) ? line + 1 : 0;
+  vector<int> knots(k.knots[line].size(), 0);
+  do {
+    int line_score;
+    vector<int> strings_out =
+        get_next_strings(strings_in, knots, first, pure, &line_score);
+    if (line_score < 0 || !knots_met(k.knots[next_line], strings_out, !first))
+      continue;
+    if (next_line)
+      count_all_knottings(k, next_line, strings_out, start, pure,
+                          score + line_score, cnts);
+    else if (strings_out == start)
+      cnts[score + line_score]++;
+  } while (increment(knots));
+}
+
+// Compare the counts of every score with counting the knottings one by one
+string check_histogram(KnotColors &k, const SolveOpts &opts)
+{
+  std::map<int, uint64_t> all;
+  k.for_each_start_strings([&](const vector<int> &strings, int, int) {
+    count_all_knottings(k, 0, strings, strings, opts.prefer_pure, 0, all);
+  });
+
+  ScoreCounts cnts = k.count(opts, true);
+  std::map<int, uint64_t> counted;
+  for (const auto &kv : cnts.get_counts())
+    counted[kv.first] = kv.second.low_bits();
+
+  for (const auto &kv : all) {
+    const uint64_t n_counted = counted.count(kv.first) ? counted[kv.first] : 0;
+    if (kv.second != n_counted)
+      return msg_str("score %d has %lu solutions, counted %lu", kv.first,
+                     (unsigned long)kv.second, (unsigned long)n_counted);
+  }
+  for (const auto &kv : counted)
+    if (!all.count(kv.first))
+      return msg_str("score %d has no solutions, counted %lu", kv.first,
+                     (unsigned long)kv.second);
+  return "";
+}
+
+EngineResult run_engine(const string &engine, KnotColors &k, bool pure)
+{
+  EngineResult res;
+  res.score = INT_MAX;
+  res.count = 0;
+  res.has_sols = true;
+  res.checked = 0;
+  res.check_secs = 0;
+
+  SolveOpts opts;
+  opts.prefer_pure = pure;
+  SolutionVerifier verifier(k, pure);
+  vector<Pattern> pats;
+  std::chrono::steady_clock::time_point check_start;
+  if (engine == "search" || engine == "generic") {
+    opts.generic_search = (engine == "generic");
+    SolutionStore solns = k.solve(opts);
+    check_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < solns.size(); i++)
+      record_check(verifier.check(solns, i), i, res);
+    res.check_secs = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - check_start)
+                         .count();
+    for (size_t i = 0; i < solns.size(); i++)
+      pats.push_back(solns.get(i));
+  }
+  else if (engine == "recursive") {
+    Pattern pat;
+    pat.set_prefer_pure(pure);
+    pat.knots.resize(k.knots.size());
+    for (unsigned int i = 0; i < k.knots.size(); i++)
+      pat.knots[i].resize(k.knots[i].size());
+    k.for_each_start_strings([&](const vector<int> &strings, int, int) {
+      pat.set_strings(strings);
+      pat.check_line(0, strings, k, pats);
+    });
+  }
+  else if (engine == "zdd") {
+    ZddStore store;
+    k.solve_zdd(opts, store);
+    ZddStore::Enumerator sols(store);
+    Pattern pat;
+    while (sols.next(pat))
+      pats.push_back(pat);
+  }
+  else if (engine == "count" || engine == "histogram") {
+    if (engine == "histogram") {
+      res.fault = check_histogram(k, opts);
+      res.checked = 1;
+    }
+    ScoreCounts cnts = k.count(opts);
+    res.has_sols = false;
+    if (!cnts.empty()) {
+      res.score = cnts.best_score();
+      res.count = cnts.get_counts().at(res.score).low_bits();
+    }
+    return res;
+  }
+
+  if (engine != "search" && engine != "generic") {
+    check_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < pats.size(); i++)
+      record_check(verifier.check(pats[i]), i, res);
+    res.check_secs = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - check_start)
+                         .count();
+  }
+
+  res.count = pats.size();
+  for (const auto &pat : pats) {
+    res.score = std::min(res.score, pat.score);
+    res.sols.push_back(solution_text(k, pat));
+  }
+  std::sort(res.sols.begin(), res.sols.end());
+  return res;
+}
+
+// Compare the results of two engines, returning the first difference
+string compare_results(const string &eng0, const EngineResult &res0,
+                       const string &eng1, const EngineResult &res1)
+{
+  if (res0.score != res1.score || res0.count != res1.count) {
+    auto summary = [](const string &eng, const EngineResult &res) {
+      if (!res.count)
+        return msg_str("%s found no solutions", eng.c_str());
+      return msg_str("%s found %lu with score %d", eng.c_str(),
+                     (unsigned long)res.count, res.score);
+    };
+    return summary(eng0, res0) + ", " + summary(eng1, res1);
+  }
+
+  if (res0.has_sols && res1.has_sols) {
+    vector<string> only0, only1;
+    std::set_difference(res0.sols.begin(), res0.sols.end(), res1.sols.begin(),
+                        res1.sols.end(), std::back_inserter(only0));
+    std::set_difference(res1.sols.begin(), res1.sols.end(), res0.sols.begin(),
+                        res0.sols.end(), std::back_inserter(only1));
+    if (only0.size())
+      return msg_str("solution only found by %s: %s", eng0.c_str(),
+                     only0[0].c_str());
+    if (only1.size())
+      return msg_str("solution only found by %s: %s", eng1.c_str(),
+                     only1[0].c_str());
+  }
+
+  return "";
+}
+
+int main(int argc, char **argv)
+{
+  DiffOpts opts;
+  opts.process_cmd_line(argc, argv);
+
+  int num_faults = 0;
+  long num_checked = 0;
+  double check_secs = 0;
+  for (int i = 0; i < opts.num_designs; i++) {
+    const int seed = opts.seed + i;
+    string strings;
+    vector<string> knot_lines;
+    random_pattern(opts.width, opts.height, opts.colours, opts.swap_prob,
+                   seed, strings, knot_lines);
+    KnotColors k;
+    Status stat = k.read(get_design(strings, knot_lines));
+    if (stat.is_error()) {
+      fprintf(stdout, "design %d (seed %d): %s\n", i, seed, stat.c_msg());
+      num_faults++;
+      continue;
+    }
+
+    vector<EngineResult> results;
+    for (const auto &engine : opts.engines) {
+      results.push_back(run_engine(engine, k, opts.prefer_pure));
+      const EngineResult &res = results.back();
+      if (res.fault != "") {
+        fprintf(stdout, "design %d (seed %d): %s %s\n", i, seed,
+                engine.c_str(), res.fault.c_str());
+        num_faults++;
+      }
+      num_checked += res.checked;
+      check_secs += res.check_secs;
+    }
+
+    if (results.size() == 2) {
+      string diff = compare_results(opts.engines[0], results[0],
+                                    opts.engines[1], results[1]);
+      if (diff != "") {
+        fprintf(stdout, "design %d (seed %d): %s\n", i, seed, diff.c_str());
+        num_faults++;
+      }
+    }
+  }
+
+  fprintf(stdout,
+          "designs: %d, solutions checked: %ld (%.0f per second), "
+          "differences: %d\n",
+          opts.num_designs, num_checked,
+          check_secs > 0 ? num_checked / check_secs : 0.0, num_faults);
+
+  return num_faults ? 1 : 0;
+}
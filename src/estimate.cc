@@ -0,0 +1,411 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file estimate.cc
+   \brief estimate of the size and time of a search, before it is made
+*/
+
+#include "estimate.h"
+#include "knotcolors.h"
+#include "pattern.h"
+#include "utils.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits.h>
+#include <math.h>
+#include <random>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// Random probes down the search tree of Pattern::check_line. The knottings
+// of a line that pass the checks are counted, and one chosen uniformly, by
+// a dynamic programme along the line: a knot of the next line is met by
+// strings from at most two neighbouring knots of the line, so the checks
+// only link neighbouring knots. With only symmetric knottings the line is
+// folded in half, and each knot variable sets a knot and its mirror.
+class TreeProber {
+private:
+  const KnotColors &kc;
+  bool prefer_pure;
+  bool only_symmetric;
+
+  // per knot variable of the current line
+  vector<int> weight;    // knots set by the variable
+  vector<char> unary;    // [v][s] the state is allowed
+  vector<char> binary;   // [v][s_prev][s] allowed with previous
+  vector<double> cnts;   // [v][s][score] knottings to v
+  vector<int> knots;     // knots of the chosen knotting
+  vector<int> strs_next; // strings leaving the chosen knotting
+
+  int var(int knot, int num_knots) const
+  {
+    return only_symmetric ? std::min(knot, num_knots - 1 - knot) : knot;
+  }
+  double choose_knotting(int line, const vector<int> &strs, int max_score,
+                         std::mt19937_64 &rng, int *line_score);
+
+public:
+  TreeProber(const KnotColors &k, bool pure, bool symmetric)
+      : kc(k), prefer_pure(pure), only_symmetric(symmetric)
+  {
+  }
+
+  /// Make a probe from a set of start strings
+  /**\param strings the start strings.
+   * \param score_limit the score limit of the search.
+   * \param rng the random number generator.
+   * \return the estimated number of descents of the search. */
+  double probe(const vector<int> &strings, int score_limit,
+               std::mt19937_64 &rng);
+};
+
+// Count the knottings of a line that pass the checks, and choose one at
+// random, setting knots and strs_next. Return the count.
+double TreeProber::choose_knotting(int line, const vector<int> &strs,
+                                   int max_score, std::mt19937_64 &rng,
+                                   int *line_score)
+{
+  if (max_score < 0)
+    return 0;
+  const int nk = kc.knots[line].size();
+  const int offset = line % 2;
+  const int nv = only_symmetric ? (nk + 1) / 2 : nk;
+  weight.assign(nv, 0);
+  for (int j = 0; j < nk; j++)
+    weight[var(j, nk)]++;
+  unary.assign(nv * 2, 1);
+  binary.assign(nv * 4, 1);
+
+  // knots of same colour strings must be the prefered type
+  for (int j = 0; j < nk; j++)
+    if (strs[offset + 2 * j] == strs[offset + 2 * j + 1])
+      unary[var(j, nk) * 2 + !prefer_pure] = 0;
+
+  // string leaving position pos, if the knot holding it has state s
+  auto str_out = [&](int pos, int s) {
+    const int knot = (pos - offset) / 2;
+    if (pos < offset || knot >= nk || !s)
+      return strs[pos];
+    return strs[(pos - offset) % 2 ? pos - 1 : pos + 1];
+  };
+  auto knot_var = [&](int pos) {
+    const int knot = (pos - offset) / 2;
+    return (pos < offset || knot >= nk) ? -1 : var(knot, nk);
+  };
+
+  // each knot of the next line must be met by one of its strings
+  const vector<int> &next_cols = kc.knots[line + 1];
+  for (unsigned int i = 0; i < next_cols.size(); i++) {
+    const int pos = !offset + 2 * i;
+    const int col = next_cols[i];
+    const int v0 = knot_var(pos);
+    const int v1 = knot_var(pos + 1);
+    for (int s0 = 0; s0 < 2; s0++) {
+      for (int s1 = 0; s1 < 2; s1++) {
+        if (v0 == v1 && s0 != s1)
+          continue;
+        if (str_out(pos, s0) == col || str_out(pos + 1, s1) == col)
+          continue;
+        if (v0 < 0 && v1 < 0)
+          return 0;
+        else if (v1 < 0 || v0 == v1)
+          unary[v0 * 2 + s0] = 0;
+        else if (v0 < 0)
+          unary[v1 * 2 + s1] = 0;
+        else if (v1 == v0 + 1)
+          binary[v1 * 4 + s0 * 2 + s1] = 0;
+        else // folded line, the variables are in the other order
+          binary[v0 * 4 + s1 * 2 + s0] = 0;
+      }
+    }
+  }
+
+  // count the knottings by variable, state and score
+  const int ns = std::min(max_score, nk) + 1;
+  cnts.assign(nv * 2 * ns, 0.0);
+  auto cnt = [&](int v, int s, int score) -> double & {
+    return cnts[(v * 2 + s) * ns + score];
+  };
+  auto cost = [&](int v, int s) { return (s != prefer_pure) * weight[v]; };
+  for (int s = 0; s < 2; s++)
+    if (unary[s] && cost(0, s) < ns)
+      cnt(0, s, cost(0, s)) = 1;
+  for (int v = 1; v < nv; v++)
+    for (int s = 0; s < 2; s++) {
+      if (!unary[v * 2 + s])
+        continue;
+      for (int sp = 0; sp < 2; sp++) {
+        if (!binary[v * 4 + sp * 2 + s])
+          continue;
+        for (int score = 0; score + cost(v, s) < ns; score++)
+          cnt(v, s, score + cost(v, s)) += cnt(v - 1, sp, score);
+      }
+    }
+
+  double total = 0;
+  for (int s = 0; s < 2; s++)
+    for (int score = 0; score < ns; score++)
+      total += cnt(nv - 1, s, score);
+  if (total == 0)
+    return 0;
+
+  // choose a knotting, from the last variable back to the first
+  std::uniform_real_distribution<double> rnd(0.0, 1.0);
+  double r = rnd(rng) * total;
+  int s = 0, score = 0;
+  for (int idx = 0; idx < 2 * ns; idx++) {
+    s = idx / ns;
+    score = idx % ns;
+    r -= cnt(nv - 1, s, score);
+    if (r < 0 && cnt(nv - 1, s, score) > 0)
+      break;
+  }
+  vector<int> states(nv);
+  states[nv - 1] = s;
+  for (int v = nv - 1; v > 0; v--) {
+    score -= cost(v, s);
+    double w[2];
+    for (int sp = 0; sp < 2; sp++)
+      w[sp] = binary[v * 4 + sp * 2 + s] ? cnt(v - 1, sp, score) : 0;
+    s = (rnd(rng) * (w[0] + w[1]) < w[0]) ? 0 : 1;
+    if (!w[s])
+      s = !s;
+    states[v - 1] = s;
+  }
+
+  knots.resize(nk);
+  for (int j = 0; j < nk; j++)
+    knots[j] = states[var(j, nk)];
+  get_next_strings(strs, knots, offset, strs_next, prefer_pure, line_score);
+  return total;
+}
+
+double TreeProber::probe(const vector<int> &strings, int score_limit,
+                         std::mt19937_64 &rng)
+{
+  // The knottings of the last line make solutions rather than descents
+  vector<int> strs = strings;
+  double descents = 1;
+  double level_size = 1;
+  int score = 0;
+  for (int line = 0; line < (int)kc.knots.size() - 1; line++) {
+    int line_score;
+    const double cnt =
+        choose_knotting(line, strs, score_limit - score, rng, &line_score);
+    if (cnt == 0)
+      break;
+    level_size *= cnt;
+    descents += level_size;
+    score += line_score;
+    strs.swap(strs_next);
+  }
+  return descents;
+}
+
+// Time as text, in the largest suitable unit
+string time_text(double secs)
+{
+  const struct {
+    const char *name;
+    double secs;
+  } units[] = {{"years", 365.25 * 86400},
+               {"days", 86400},
+               {"hours", 3600},
+               {"minutes", 60}};
+  for (const auto &unit : units)
+    if (secs >= unit.secs)
+      return msg_str("%.3g %s", secs / unit.secs, unit.name);
+  return msg_str("%.3g seconds", secs);
+}
+
+} // namespace
+
+SearchEstimate::SearchEstimate()
+    : colour_sets(0), probes(0), seed(0), score_limit(-1), descents(0),
+      std_error(0), calib_descents(0), calib_seconds(0), calib_finished(false),
+      descents_per_sec(0), seconds(0)
+{
+}
+
+void SearchEstimate::estimate(KnotColors &k, const SolveOpts &opts,
+                              int num_probes, double calibrate_secs,
+                              int rnd_seed)
+{
+  *this = SearchEstimate();
+  seed = rnd_seed;
+
+  // count the start string permutations of each set of free colours
+  vector<vector<int>> start_strings;
+  vector<double> perm_cnts;
+  vector<int> free_strings(k.num_colours, 0);
+  while (get_next_cnts(free_strings, k.num_free_strings)) {
+    start_strings.push_back(k.get_start_strings(free_strings));
+    vector<int> col_cnts(k.num_colours, 0);
+    for (int str : start_strings.back())
+      col_cnts[str]++;
+    BigCount perms = 1; // multinomial coefficient
+    uint32_t pos = 0;
+    for (int cnt : col_cnts)
+      for (int i = 1; i <= cnt; i++) {
+        perms *= ++pos;
+        perms /= i;
+      }
+    permutations += perms;
+    perm_cnts.push_back(perms.to_double());
+    if (k.num_free_strings == 0)
+      break;
+  }
+  colour_sets = start_strings.size();
+
+  // run the search for a while, to measure its speed and find a score limit
+  SolveOpts calib_opts;
+  calib_opts.prefer_pure = opts.prefer_pure;
+  calib_opts.only_symmetric = opts.only_symmetric;
+  calib_opts.optimal = opts.optimal;
+  calib_opts.generic_search = opts.generic_search;
+  std::atomic<bool> cancel(false);
+  calib_opts.cancel = &cancel;
+  const auto start_time = std::chrono::steady_clock::now();
+  auto check_time = [&]() {
+    if (std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                      start_time)
+            .count() >= calibrate_secs)
+      cancel = true;
+  };
+  calib_opts.descents = [&](long) { check_time(); };
+  calib_opts.progress = [&](const SolveProgress &) { check_time(); };
+  // not with SearchStats, which selects a slower search
+  long search_descents = 0;
+  calib_opts.descent_total = &search_descents;
+  SolutionStore solns = k.solve(calib_opts);
+  calib_descents = search_descents;
+  calib_seconds = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start_time)
+                      .count();
+  calib_finished = !cancel;
+  if (calib_seconds > 0)
+    descents_per_sec = calib_descents / calib_seconds;
+  if (solns.size())
+    score_limit = solns.score(0);
+  else if (!calib_finished) {
+    // without a score limit the probes prune nothing, and the estimate
+    // may be far too high, so find the best score with the count, which
+    // is much faster than the search, or the best in ten times as long
+    SolveOpts count_opts;
+    count_opts.prefer_pure = opts.prefer_pure;
+    count_opts.only_symmetric = opts.only_symmetric;
+    cancel = false;
+    count_opts.cancel = &cancel;
+    const auto count_start = std::chrono::steady_clock::now();
+    count_opts.progress = [&](const SolveProgress &) {
+      if (std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                        count_start)
+              .count() >= 10 * calibrate_secs)
+        cancel = true;
+    };
+    ScoreCounts cnts = k.count(count_opts);
+    if (!cnts.empty())
+      score_limit = cnts.best_score();
+  }
+
+  if (calib_finished) {
+    descents = calib_descents;
+    seconds = calib_seconds;
+    return;
+  }
+
+  // probe random start string permutations, chosen uniformly
+  std::mt19937_64 rng(rnd_seed);
+  std::discrete_distribution<int> rnd_set(perm_cnts.begin(), perm_cnts.end());
+  TreeProber prober(k, opts.prefer_pure, opts.only_symmetric);
+  const int limit = score_limit >= 0 ? score_limit : INT_MAX;
+  double sum = 0, sum_sq = 0;
+  for (probes = 0; probes < num_probes; probes++) {
+    vector<int> strings = start_strings[rnd_set(rng)];
+    std::shuffle(strings.begin(), strings.end(), rng);
+    const double est = prober.probe(strings, limit, rng);
+    sum += est;
+    sum_sq += est * est;
+  }
+
+  const double num_perms = permutations.to_double();
+  const double mean = sum / probes;
+  // the search was not finished in the calibration
+  descents = std::max(num_perms * mean, calib_descents);
+  if (probes > 1) {
+    const double var = (sum_sq - probes * mean * mean) / (probes - 1);
+    std_error = num_perms * sqrt(std::max(var, 0.0) / probes);
+  }
+  seconds = descents_per_sec > 0 ? descents / descents_per_sec : 0;
+}
+
+void SearchEstimate::print(FILE *ofile) const
+{
+  fprintf(ofile, "\n-------------------------------------------\n");
+  if (calib_finished)
+    fprintf(ofile, "Search finished during calibration\n\n");
+  else
+    fprintf(ofile, "Search estimate (probes: %d, seed: %d)\n\n", probes,
+            seed);
+  fprintf(ofile, "Sets of free string colours: %ld\n", colour_sets);
+  fprintf(ofile, "Start string permutations:   %s\n",
+          permutations.to_string().c_str());
+  if (score_limit >= 0)
+    fprintf(ofile, "Score limit of probes:       %d\n", score_limit);
+  fprintf(ofile, "Calibration:                 %.0f descents in %.2f s\n",
+          calib_descents, calib_seconds);
+  fprintf(ofile, "Speed:                       %.3g descents/s\n",
+          descents_per_sec);
+  if (calib_finished) {
+    fprintf(ofile, "Descents:                    %.0f\n", descents);
+    fprintf(ofile, "Time:                        %s\n",
+            time_text(seconds).c_str());
+  }
+  else {
+    fprintf(ofile, "Predicted descents:          %.3g (standard error "
+                   "%.3g%%)\n",
+            descents, descents > 0 ? 100 * std_error / descents : 0.0);
+    fprintf(ofile, "Predicted time:              %s\n",
+            time_text(seconds).c_str());
+  }
+  fprintf(ofile, "\n");
+}
+
+void SearchEstimate::print_json(FILE *ofile) const
+{
+  fprintf(ofile,
+          "{\"colour_sets\":%ld,\"permutations\":\"%s\",\"probes\":%d,"
+          "\"seed\":%d,\"score_limit\":%s,\"descents\":%.6g,"
+          "\"std_error\":%.6g,\"calibration\":{\"descents\":%.0f,"
+          "\"seconds\":%.3f,\"finished\":%s},\"descents_per_second\":%.6g,"
+          "\"seconds\":%.6g}\n",
+          colour_sets, permutations.to_string().c_str(), probes, seed,
+          score_limit >= 0 ? msg_str("%d", score_limit).c_str() : "null",
+          descents, std_error, calib_descents, calib_seconds,
+          calib_finished ? "true" : "false", descents_per_sec, seconds);
+}
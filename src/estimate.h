@@ -0,0 +1,86 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file estimate.h
+   \brief estimate of the size and time of a search, before it is made
+*/
+
+#ifndef ESTIMATE_H
+#define ESTIMATE_H
+
+#include "solutioncount.h"
+#include <stdio.h>
+
+class KnotColors;
+class SolveOpts;
+
+/// Estimate of the size and time of a search
+/** The sets of free string colours and the start string permutations are
+ *  counted exactly. The search is run for a short calibration time, to
+ *  measure the descents per second on this machine and to find a score
+ *  limit. The descents of the whole search are then estimated with
+ *  Knuth's estimator: each probe follows a random path down the search
+ *  tree of a random start string permutation, and the product of the
+ *  numbers of knottings that pass the checks at each line estimates the
+ *  size of each level of the tree. The score limit of the search falls
+ *  as better solutions are found, so the estimate, which uses the
+ *  limit from the calibration, is for a search that already has that
+ *  limit. */
+class SearchEstimate {
+public:
+  long colour_sets;        ///< sets of free string colour counts
+  BigCount permutations;   ///< start string permutations
+  int probes;              ///< number of random probes made
+  int seed;                ///< seed for the random probes
+  int score_limit;         ///< score limit used in the probes, or -1 if none
+  double descents;         ///< predicted descents of the search
+  double std_error;        ///< standard error of the predicted descents
+  double calib_descents;   ///< descents made in the calibration search
+  double calib_seconds;    ///< time taken by the calibration search
+  bool calib_finished;     ///< the calibration search was the whole search
+  double descents_per_sec; ///< measured speed of the search
+  double seconds;          ///< predicted time of the search
+
+  /// Constructor
+  SearchEstimate();
+
+  /// Estimate the search of a design
+  /**\param k the design.
+   * \param opts the options of the search (the solution limits, cache,
+   *  cancel flag and callbacks are not used).
+   * \param num_probes the number of random probes to make.
+   * \param calibrate_secs the time to run the search for, to measure its
+   *  speed.
+   * \param rnd_seed the seed for the random probes. */
+  void estimate(KnotColors &k, const SolveOpts &opts, int num_probes,
+                double calibrate_secs, int rnd_seed);
+
+  /// Print the estimate as a table
+  /**\param ofile the file to print to. */
+  void print(FILE *ofile) const;
+
+  /// Print the estimate as a JSON object, on one line
+  /**\param ofile the file to print to. */
+  void print_json(FILE *ofile) const;
+};
+
+#endif // ESTIMATE_H
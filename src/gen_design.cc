@@ -0,0 +1,171 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file gen_design.cc
+   \brief generate random designs that have a known solution
+*/
+
+#include "pattext.h"
+#include "programopts.h"
+#include "utils.h"
+#include <stdio.h>
+#include <string>
+#include <time.h>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+class GenOpts : public ProgramOpts {
+public:
+  int width;
+  int height;
+  int colours;
+  double swap_prob;
+  int seed;
+  bool seed_set;
+  string pat_file;
+
+  GenOpts()
+      : ProgramOpts("gen_design"), width(12), height(12), colours(3),
+        swap_prob(0.5), seed(0), seed_set(false)
+  {
+  }
+  void process_cmd_line(int argc, char **argv);
+  void usage();
+};
+
+void GenOpts::usage()
+{
+  fprintf(stdout,
+          "\n"
+          "Usage: %s [options]\n"
+          "\n"
+          "Generate a random knotting pattern whose strings return to their\n"
+          "starting colours at the end of the pattern, and write the design\n"
+          "it makes to standard output. The design can be repeated and\n"
+          "always has a solution, the generated pattern. The pattern starts\n"
+          "with random knots, and the last lines bring the strings back to\n"
+          "their starting order.\n"
+          "\n"
+          "Options\n"
+          "  -h         print this help text\n"
+          "  -v         print the program version and licence\n"
+          "  -w <n>     number of strings (default: 12)\n"
+          "  -l <n>     number of knot lines, must be even (default: 12)\n"
+          "  -c <n>     number of colours, from 1 to 26 (default: 3)\n"
+          "  -p <prob>  probability that a random knot swaps its strings\n"
+          "             (default: 0.5)\n"
+          "  -s <n>     seed for random choices (default: from the time)\n"
+          "  -o <file>  write the generated pattern to file, in the generator\n"
+          "             pattern format that pat2design reads\n"
+          "\n",
+          prog_name());
+}
+
+void GenOpts::process_cmd_line(int argc, char **argv)
+{
+  opterr = 0;
+  int c;
+
+  handle_long_opts(argc, argv);
+
+  while ((c = getopt(argc, argv, ":hvw:l:c:p:s:o:")) != -1) {
+    if (common_opts(c, optopt))
+      continue;
+
+    switch (c) {
+    case 'w':
+      print_status_or_exit(read_int(optarg, &width), c);
+      if (width < 3)
+        error("number of strings must be 3 or more", c);
+      break;
+
+    case 'l':
+      print_status_or_exit(read_int(optarg, &height), c);
+      if (height < 2 || height % 2)
+        error("number of knot lines must be even, and 2 or more", c);
+      break;
+
+    case 'c':
+      print_status_or_exit(read_int(optarg, &colours), c);
+      if (colours < 1 || colours > 26)
+        error("number of colours must be from 1 to 26", c);
+      break;
+
+    case 'p':
+      print_status_or_exit(read_double(optarg, &swap_prob), c);
+      if (swap_prob < 0 || swap_prob > 1)
+        error("probability must be from 0 to 1", c);
+      break;
+
+    case 's':
+      print_status_or_exit(read_int(optarg, &seed), c);
+      seed_set = true;
+      break;
+
+    case 'o':
+      pat_file = optarg;
+      break;
+
+    default:
+      error("unknown command line error");
+    }
+  }
+
+  if (argc - optind > 0)
+    error("too many arguments");
+
+  if (colours > width)
+    error(msg_str("number of colours is greater than the number of "
+                  "strings (%d)",
+                  width),
+          'c');
+
+  if (!seed_set)
+    seed = (int)time(nullptr);
+}
+
+int main(int argc, char **argv)
+{
+  GenOpts opts;
+  opts.process_cmd_line(argc, argv);
+
+  string strings;
+  vector<string> knot_lines;
+  random_pattern(opts.width, opts.height, opts.colours, opts.swap_prob,
+                 opts.seed, strings, knot_lines);
+
+  if (opts.pat_file != "") {
+    FILE *pfile = fopen(opts.pat_file.c_str(), "w");
+    if (!pfile)
+      opts.error(msg_str("could not open output file '%s'",
+                         opts.pat_file.c_str()),
+                 'o');
+    print_pattern_text(strings, knot_lines, pfile);
+    fclose(pfile);
+  }
+
+  print_result(strings, knot_lines, false, stdout);
+
+  return 0;
+}
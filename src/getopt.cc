@@ -348,7 +348,7 @@ int GetOpt::has_separate_argument(int curopt, int argc, char *const argv[],
          strchr(optleaders, argv[curopt][0]));
 
   /* Check if we have a long option */
-  longind = match_longopt(ultraoptind, argv, longopts, assigners, optleaders,
+  longind = match_longopt(curopt, argv, longopts, assigners, optleaders,
                           flags, &longarg);
   if (longind >= 0) {
     if (longopts[longind].has_arg == no_argument || longarg != nullptr ||
@@ -0,0 +1,619 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "../config.h"
+#endif
+
+#include "jobserver.h"
+#include "bracelet.h"
+#include "utils.h"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <limits.h>
+#include <string.h>
+#include <thread>
+
+#if defined(HAVE_SYS_SOCKET_H) && defined(HAVE_SYS_UN_H)
+#include <errno.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define HAVE_UNIX_SOCKETS 1
+#endif
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+// Responses are queued, and written by a thread of the session, so a
+// client that stops reading cannot hold up the jobs or other clients. A
+// client that falls too far behind is disconnected, or for a stream is
+// sent no further responses.
+struct JobServer::Session {
+  FILE *ifile;
+  FILE *ofile;
+  int fd; // socket of a client, or -1 for a stream
+  std::mutex out_mtx;
+  std::condition_variable out_cv;
+  std::deque<string> out_lines; // responses waiting to be written
+  size_t out_bytes;             // size of the responses waiting
+  bool closing;                 // write the responses waiting, then stop
+  bool broken;                  // responses can no longer be written
+  bool written;                 // the writer has stopped
+  std::thread writer;
+  int num_jobs; // jobs waiting for, guarded by the server mutex
+
+  static const size_t max_out_bytes = 1 << 24;
+
+  Session(FILE *in, FILE *out, int sock = -1)
+      : ifile(in), ofile(out), fd(sock), out_bytes(0), closing(false),
+        broken(false), written(false), num_jobs(0)
+  {
+    writer = std::thread(&Session::write_lines, this);
+  }
+
+  ~Session() { close_output(); }
+
+  // queue a response line
+  void send(const string &line)
+  {
+    std::lock_guard<std::mutex> lock(out_mtx);
+    if (broken || closing)
+      return;
+    if (out_bytes + line.size() + 1 > max_out_bytes) {
+      broken = true;
+      out_lines.clear();
+      disconnect();
+    }
+    else {
+      out_lines.push_back(line);
+      out_bytes += line.size() + 1;
+    }
+    out_cv.notify_all();
+  }
+
+  // write the responses as they are queued
+  void write_lines()
+  {
+    std::unique_lock<std::mutex> lock(out_mtx);
+    while (true) {
+      out_cv.wait(lock, [this] {
+        return broken || closing || !out_lines.empty();
+      });
+      if (broken || out_lines.empty()) // or closing, with nothing waiting
+        break;
+      string line;
+      line.swap(out_lines.front());
+      out_lines.pop_front();
+      out_bytes -= line.size() + 1;
+      lock.unlock();
+      const bool failed =
+          fprintf(ofile, "%s\n", line.c_str()) < 0 || fflush(ofile);
+      lock.lock();
+      if (failed)
+        broken = true;
+    }
+    written = true;
+    out_cv.notify_all();
+  }
+
+  // end the connection of a client, with the output mutex held
+  void disconnect()
+  {
+#ifdef HAVE_UNIX_SOCKETS
+    if (fd >= 0)
+      shutdown(fd, SHUT_RDWR); // the session ends, and its jobs are cancelled
+#endif
+  }
+
+  // stop writing responses, before the output is closed. A client has a
+  // few seconds to read the responses waiting.
+  void close_output()
+  {
+    {
+      std::unique_lock<std::mutex> lock(out_mtx);
+      closing = true;
+      out_cv.notify_all();
+      if (fd >= 0 &&
+          !out_cv.wait_for(lock, std::chrono::seconds(5),
+                           [this] { return written; }))
+        disconnect();
+    }
+    if (writer.joinable())
+      writer.join();
+  }
+
+  // write a response to a request with an id
+  void send(const string &id, const string &body)
+  {
+    send("{\"id\":" + json_str(id) + "," + body + "}");
+  }
+};
+
+struct JobServer::Job {
+  string key;
+  vector<string> lines;
+  JobOpts opts;
+  int queued_priority; // highest priority the job was queued with
+  std::atomic<bool> cancel;
+  bool started;            // guarded by the server mutex
+  vector<Subscriber> subs; // guarded by the server mutex
+  int num_found;           // solutions sent, guarded by the server mutex
+  int found_score;         // best score sent, guarded by the server mutex
+  vector<string> found;    // events of the solutions sent with the best
+                           // score, guarded by the server mutex
+
+  Job()
+      : queued_priority(INT_MIN), cancel(false), started(false),
+        num_found(0), found_score(INT_MAX)
+  {
+  }
+
+  // queue an event for every subscriber, with the server mutex held to
+  // keep the events in order (queuing does not wait for the clients)
+  void send_all(const string &body)
+  {
+    for (const auto &sub : subs)
+      sub.first->send(sub.second, body);
+  }
+};
+
+Status parse_job_opts(const vector<string> &parts, JobServer::JobOpts &opts)
+{
+  opts = JobServer::JobOpts();
+  bool no_prove = false;
+  for (const auto &part : parts) {
+    const size_t eq = part.find('=');
+    const string name = part.substr(0, eq);
+    const string val = (eq != string::npos) ? part.substr(eq + 1) : "";
+    Status stat;
+    if (part == "-m")
+      opts.prefer_pure = false;
+    else if (part == "-s")
+      opts.only_symmetric = true;
+    else if (part == "--first") {
+      opts.max_solutions = 1;
+      no_prove = true;
+    }
+    else if (part == "--no-prove")
+      no_prove = true;
+    else if (name == "--max-solutions") {
+      stat = read_int(val.c_str(), &opts.max_solutions);
+      if (stat && opts.max_solutions < 1)
+        stat.set_error("number of solutions must be 1 or more");
+    }
+    else if (name == "--priority")
+      stat = read_int(val.c_str(), &opts.priority);
+    else
+      stat.set_error("unknown option");
+    if (!stat)
+      return Status::error(msg_str("option '%s': %s", part.c_str(),
+                                   stat.c_msg()));
+  }
+
+  if (no_prove && !opts.max_solutions)
+    return Status::error("option '--no-prove': only valid with "
+                         "--max-solutions");
+  opts.prove_optimal = !no_prove;
+  return Status::ok();
+}
+
+JobServer::JobServer(int num_threads)
+    : pool(num_threads), listen_fd(-1), stopping(false)
+{
+}
+
+JobServer::~JobServer() { pool.wait(); }
+
+void JobServer::serve_stream(FILE *ifile, FILE *ofile)
+{
+  auto sess = std::make_shared<Session>(ifile, ofile);
+  run_session(sess, false);
+  sess->close_output();
+}
+
+void JobServer::run_session(shared_ptr<Session> sess, bool cancel_at_end)
+{
+  bool in_design = false; // reading the lines of a design
+  bool bad_job = false;   // the design being read is for a bad request
+  string job_id;
+  JobOpts job_opts;
+  vector<string> design;
+
+  char *line = nullptr;
+  vector<char *> parts;
+  while (read_line(sess->ifile, &line) == 0) {
+    string text = line;
+    const int num_parts = split_line(line, parts);
+    vector<string> words(parts.begin(), parts.begin() + num_parts);
+    free(line);
+    line = nullptr;
+
+    if (in_design) {
+      if (num_parts == 1 && words[0] == "end") {
+        if (!bad_job)
+          submit(sess, job_id, job_opts, design);
+        in_design = false;
+      }
+      else
+        design.push_back(text);
+      continue;
+    }
+
+    if (num_parts == 0)
+      continue;
+    const string &cmd = words[0];
+    if (cmd == "solve") {
+      in_design = true;
+      bad_job = false;
+      design.clear();
+      job_id = (num_parts > 1) ? words[1] : "";
+      Status stat = (num_parts > 1)
+                        ? parse_job_opts(vector<string>(words.begin() + 2,
+                                                        words.end()),
+                                         job_opts)
+                        : Status::error("no job id given");
+      if (!stat) {
+        sess->send(job_id, "\"event\":\"error\",\"message\":" +
+                               json_str(stat.msg()));
+        bad_job = true;
+      }
+    }
+    else if (cmd == "cancel" && num_parts == 2)
+      cancel(sess, words[1]);
+    else if (cmd == "status" && num_parts == 1)
+      send_status(sess);
+    else if (cmd == "quit" && num_parts == 1)
+      break;
+    else if (cmd == "shutdown" && num_parts == 1) {
+      stop();
+      break;
+    }
+    else
+      sess->send("{\"event\":\"error\",\"message\":" +
+                 json_str("invalid request: " + text) + "}");
+  }
+  free(line);
+
+  if (cancel_at_end)
+    cancel_all(sess);
+  std::unique_lock<std::mutex> lock(mtx);
+  sessions_done.wait(lock, [&sess] { return sess->num_jobs == 0; });
+}
+
+void JobServer::submit(shared_ptr<Session> sess, const string &id,
+                       const JobOpts &opts, const vector<string> &lines)
+{
+  string key = msg_str("%d %d %d %d\n", opts.prefer_pure, opts.only_symmetric,
+                       opts.max_solutions, opts.prove_optimal);
+  for (const auto &line : lines)
+    key += line + "\n";
+
+  std::lock_guard<std::mutex> lock(mtx);
+  if (stopping) {
+    sess->send(id, "\"event\":\"error\",\"message\":" +
+                       json_str("server is shutting down"));
+    return;
+  }
+  for (const auto &kp : jobs)
+    for (const auto &sub : kp.second->subs)
+      if (sub.first == sess && sub.second == id) {
+        sess->send(id, "\"event\":\"error\",\"message\":" +
+                           json_str("job id is in use"));
+        return;
+      }
+
+  shared_ptr<Job> job;
+  auto it = jobs.find(key);
+  const bool coalesced = (it != jobs.end());
+  if (coalesced)
+    job = it->second;
+  else {
+    job = std::make_shared<Job>();
+    job->key = key;
+    job->lines = lines;
+    job->opts = opts;
+    jobs[key] = job;
+  }
+  job->subs.push_back(Subscriber(sess, id));
+  sess->num_jobs++;
+  sess->send(id, msg_str("\"event\":\"queued\",\"coalesced\":%s",
+                         coalesced ? "true" : "false"));
+
+  // a job joined while it runs first gets the solutions not replaced
+  if (job->started) {
+    sess->send(id, "\"event\":\"started\"");
+    for (const auto &body : job->found)
+      sess->send(id, body);
+  }
+
+  // a job joined with a higher priority is queued again, and run by
+  // whichever task starts first
+  if (!job->started && opts.priority > job->queued_priority) {
+    job->queued_priority = opts.priority;
+    pool.add([this, job] { run_job(job); }, opts.priority);
+  }
+}
+
+void JobServer::cancel(shared_ptr<Session> sess, const string &id)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  for (auto it = jobs.begin(); it != jobs.end(); ++it) {
+    Job &job = *it->second;
+    for (auto si = job.subs.begin(); si != job.subs.end(); ++si) {
+      if (si->first == sess && si->second == id) {
+        job.subs.erase(si);
+        sess->num_jobs--;
+        sess->send(id, "\"event\":\"done\",\"status\":\"cancelled\"");
+        if (job.subs.empty()) { // no one is waiting for the job
+          job.cancel = true;
+          jobs.erase(it);
+        }
+        sessions_done.notify_all();
+        return;
+      }
+    }
+  }
+  sess->send(id, "\"event\":\"error\",\"message\":" +
+                     json_str("no waiting or running job with this id"));
+}
+
+void JobServer::cancel_all(shared_ptr<Session> sess)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  for (auto it = jobs.begin(); it != jobs.end();) {
+    Job &job = *it->second;
+    for (auto si = job.subs.begin(); si != job.subs.end();) {
+      if (si->first == sess) {
+        si = job.subs.erase(si);
+        sess->num_jobs--;
+      }
+      else
+        ++si;
+    }
+    if (job.subs.empty()) {
+      job.cancel = true;
+      it = jobs.erase(it);
+    }
+    else
+      ++it;
+  }
+  sessions_done.notify_all();
+}
+
+void JobServer::send_status(shared_ptr<Session> sess)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  int running = 0;
+  for (const auto &kp : jobs)
+    running += kp.second->started;
+  sess->send(msg_str("{\"event\":\"status\",\"jobs\":%d,\"waiting\":%d,"
+                     "\"running\":%d,\"threads\":%d}",
+                     (int)jobs.size(), (int)jobs.size() - running, running,
+                     pool.size()));
+}
+
+void JobServer::run_job(shared_ptr<Job> job)
+{
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (job->started) // already run by another task
+      return;
+    job->started = true;
+    job->send_all("\"event\":\"started\"");
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  auto secs_since = [](std::chrono::steady_clock::time_point from) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         from)
+        .count();
+  };
+
+  // solutions are sent as they are found, and a solution with a better
+  // score replaces those sent before it
+  BraceletCallbacks callbacks;
+  callbacks.solution = [&](const BraceletSolution &sol) {
+    string knots;
+    for (const auto &knots_line : sol.knots)
+      knots += (knots.empty() ? "" : ",") + json_str(knots_line);
+    std::lock_guard<std::mutex> lock(mtx);
+    if (sol.score < job->found_score) {
+      job->found_score = sol.score;
+      job->found.clear();
+    }
+    job->found.push_back(
+        msg_str("\"event\":\"solution\",\"index\":%d,\"score\":%d,"
+                "\"ref\":\"%d/%d/%d\",",
+                job->num_found++, sol.score, sol.strs_no, sol.perm_no,
+                sol.var_no) +
+        "\"strings\":" + json_str(sol.strings) + ",\"knots\":[" + knots +
+        "]");
+    job->send_all(job->found.back());
+  };
+  auto last_progress = start;
+  callbacks.progress = [&](const BraceletProgress &prog) {
+    if (secs_since(last_progress) < 1)
+      return;
+    last_progress = std::chrono::steady_clock::now();
+    const string body =
+        msg_str("\"event\":\"progress\",\"strs_no\":%d,\"perm_no\":%d,",
+                prog.strs_no, prog.perm_no) +
+        "\"strings\":" + json_str(prog.strings) +
+        msg_str(",\"descents\":%ld,\"seconds\":%.3f", prog.descents,
+                secs_since(start));
+    std::lock_guard<std::mutex> lock(mtx);
+    job->send_all(body);
+  };
+
+  BraceletOpts opts;
+  opts.prefer_pure = job->opts.prefer_pure;
+  opts.only_symmetric = job->opts.only_symmetric;
+  opts.max_solutions = job->opts.max_solutions;
+  opts.prove_optimal = job->opts.prove_optimal;
+  BraceletResult result;
+  if (!job->cancel)
+    result = bracelet_solve(job->lines, opts, callbacks, &job->cancel);
+  const double secs = secs_since(start);
+
+  const vector<BraceletSolution> &solns = result.solutions;
+  string done;
+  if (job->cancel)
+    done = "\"event\":\"done\",\"status\":\"cancelled\"";
+  else if (!result.stat)
+    done = "\"event\":\"done\",\"status\":\"error\",\"message\":" +
+           json_str(result.stat.msg());
+  else
+    done = msg_str("\"event\":\"done\",\"status\":\"ok\",\"solutions\":%d,",
+                   (int)solns.size()) +
+           (solns.size() ? msg_str("\"best_score\":%d,", solns[0].score)
+                         : string("\"best_score\":null,")) +
+           msg_str("\"seconds\":%.3f", secs);
+
+  // later requests for the same job make a new job
+  vector<Subscriber> subs;
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = jobs.find(job->key);
+    if (it != jobs.end() && it->second == job)
+      jobs.erase(it);
+    subs.swap(job->subs);
+  }
+  for (const auto &sub : subs)
+    sub.first->send(sub.second, done);
+
+  std::lock_guard<std::mutex> lock(mtx);
+  for (const auto &sub : subs)
+    sub.first->num_jobs--;
+  sessions_done.notify_all();
+}
+
+void JobServer::stop()
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  stopping = true;
+  for (const auto &kp : jobs)
+    kp.second->cancel = true;
+#ifdef HAVE_UNIX_SOCKETS
+  if (listen_fd >= 0)
+    shutdown(listen_fd, SHUT_RDWR);
+  for (int fd : session_fds)
+    shutdown(fd, SHUT_RD);
+#endif
+}
+
+#ifdef HAVE_UNIX_SOCKETS
+
+void JobServer::run_socket_session(int fd)
+{
+  FILE *ifile = fdopen(fd, "r");
+  FILE *ofile = fdopen(dup(fd), "w");
+  if (ifile && ofile) {
+    auto sess = std::make_shared<Session>(ifile, ofile, fd);
+    run_session(sess, true); // the client has gone, or will not read
+    sess->close_output();
+  }
+  if (ofile)
+    fclose(ofile);
+
+  // the descriptor is closed with the lock held, so that it is not reused
+  // by a new client before it is removed
+  std::lock_guard<std::mutex> lock(mtx);
+  if (ifile)
+    fclose(ifile);
+  else
+    close(fd);
+  session_fds.erase(fd);
+  sessions_done.notify_all();
+}
+
+Status JobServer::serve_socket(const string &path)
+{
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path))
+    return Status::error(msg_str("socket path is too long: '%s'",
+                                 path.c_str()));
+  strcpy(addr.sun_path, path.c_str());
+
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    return Status::error(msg_str("could not make socket: %s",
+                                 strerror(errno)));
+  unlink(path.c_str());
+  if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+      listen(fd, 16) < 0) {
+    Status stat = Status::error(msg_str("could not listen on socket '%s': %s",
+                                        path.c_str(), strerror(errno)));
+    close(fd);
+    return stat;
+  }
+  signal(SIGPIPE, SIG_IGN); // a write to a closed client will fail instead
+
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    listen_fd = fd;
+  }
+  while (true) {
+    const int client_fd = accept(fd, nullptr, nullptr);
+    const int accept_errno = errno;
+    std::lock_guard<std::mutex> lock(mtx);
+    if (stopping) {
+      if (client_fd >= 0)
+        close(client_fd);
+      break;
+    }
+    if (client_fd < 0) {
+      if (accept_errno == EINTR || accept_errno == ECONNABORTED)
+        continue;
+      break;
+    }
+    session_fds.insert(client_fd);
+    std::thread(&JobServer::run_socket_session, this, client_fd).detach();
+  }
+
+  std::unique_lock<std::mutex> lock(mtx);
+  for (int session_fd : session_fds)
+    shutdown(session_fd, SHUT_RD);
+  sessions_done.wait(lock, [this] { return session_fds.empty(); });
+  listen_fd = -1;
+  close(fd);
+  unlink(path.c_str());
+  return Status::ok();
+}
+
+#else
+
+void JobServer::run_socket_session(int) {}
+
+Status JobServer::serve_socket(const string &)
+{
+  return Status::error("Unix domain sockets are not supported on this "
+                       "system");
+}
+
+#endif // HAVE_UNIX_SOCKETS
@@ -0,0 +1,136 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file jobserver.h
+   \brief long running server solving designs sent to it
+*/
+
+#ifndef JOBSERVER_H
+#define JOBSERVER_H
+
+#include "status.h"
+#include "threadpool.h"
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/// Server solving designs sent to it, with a shared pool of workers
+/** Requests are read as lines of text, from a stream or from clients
+ *  connected to a Unix domain socket
+ *
+ *     solve <id> [-m] [-s] [--max-solutions=<n>] [--first] [--no-prove]
+ *                [--priority=<n>]
+ *     <the lines of the design>
+ *     end
+ *     cancel <id>
+ *     status
+ *     quit
+ *     shutdown
+ *
+ *  and each response is written as a line holding a JSON object. A job
+ *  that is the same as one waiting or running is joined to it, rather
+ *  than solved again. The events of a job are \c queued, \c started,
+ *  \c solution for each solution as it is found, with the knots of each
+ *  line in the generator pattern format as in the JSON report,
+ *  \c progress at most once a second, and \c done. A solution with a
+ *  better score replaces the solutions sent before it, so the solutions
+ *  of the job are those sent with the best score given by \c done, and
+ *  a job joined while it runs is sent only those. \c quit ends a session,
+ *  and \c shutdown (for a socket) stops the server. Jobs from a stream
+ *  are finished before the session ends, while jobs from a socket client
+ *  are cancelled when the client disconnects. Responses are queued for
+ *  each session, and a client that falls 16 MB behind in reading them is
+ *  disconnected. */
+class JobServer {
+public:
+  /// Options of a job
+  struct JobOpts {
+    bool prefer_pure;    ///< find solution with most pure/mixed knots
+    bool only_symmetric; ///< only look for symmetric solutions
+    int max_solutions;   ///< stop adding solutions after this many
+    bool prove_optimal;  ///< after max_solutions, search for better
+    int priority;        ///< jobs with higher priority run first
+
+    JobOpts()
+        : prefer_pure(true), only_symmetric(false), max_solutions(0),
+          prove_optimal(true), priority(0)
+    {
+    }
+  };
+
+private:
+  struct Session;
+  struct Job;
+  typedef std::pair<std::shared_ptr<Session>, std::string> Subscriber;
+
+  ThreadPool pool;
+  std::mutex mtx;
+  std::condition_variable sessions_done;
+  std::map<std::string, std::shared_ptr<Job>> jobs; // waiting or running
+  std::set<int> session_fds;
+  int listen_fd;
+  bool stopping;
+
+  void run_session(std::shared_ptr<Session> sess, bool cancel_at_end);
+  void run_socket_session(int fd);
+  void submit(std::shared_ptr<Session> sess, const std::string &id,
+              const JobOpts &opts, const std::vector<std::string> &lines);
+  void cancel(std::shared_ptr<Session> sess, const std::string &id);
+  void cancel_all(std::shared_ptr<Session> sess);
+  void send_status(std::shared_ptr<Session> sess);
+  void run_job(std::shared_ptr<Job> job);
+  void stop();
+
+public:
+  /// Constructor
+  /**\param num_threads the number of jobs to run at once, or \c 0 to use
+   *  the number of hardware threads. */
+  explicit JobServer(int num_threads = 0);
+
+  /// Destructor, waits for the jobs to finish
+  ~JobServer();
+
+  /// Serve requests read from a stream, until the end of the stream
+  /**\param ifile the stream to read requests from.
+   * \param ofile the stream to write responses to. */
+  void serve_stream(FILE *ifile, FILE *ofile);
+
+  /// Serve requests from clients of a Unix domain socket
+  /** Runs until a client sends \c shutdown.
+   * \param path the path of the socket.
+   * \return status, evaluates to \c true if the socket was served. */
+  Status serve_socket(const std::string &path);
+};
+
+/// Parse the options of a job
+/**\param parts the options, as command line arguments.
+ * \param opts used to return the options.
+ * \return status, evaluates to \c true if the options were valid. */
+Status parse_job_opts(const std::vector<std::string> &parts,
+                      JobServer::JobOpts &opts);
+
+#endif // JOBSERVER_H
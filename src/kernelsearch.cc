@@ -0,0 +1,69 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "kernelsearch.h"
+
+using std::vector;
+
+namespace {
+
+typedef LineSearch *(*KernelFactory)(Pattern &pattern, const KnotColors &k,
+                                     SolutionStore &solutions, bool optimal);
+
+template <int NS>
+LineSearch *new_search(Pattern &pattern, const KnotColors &k,
+                       SolutionStore &solutions, bool optimal)
+{
+  return new KernelSearch<NS>(pattern, k, solutions, optimal);
+}
+
+// Fill a table, indexed by number of strings, with the search factories
+// for 3 (the fewest strings for two knot lines) to NS strings
+template <int NS> struct KernelFactories {
+  static void fill(KernelFactory *factories)
+  {
+    factories[NS] = new_search<NS>;
+    KernelFactories<NS - 1>::fill(factories);
+  }
+};
+
+template <> struct KernelFactories<2> {
+  static void fill(KernelFactory *) {}
+};
+
+struct KernelTable {
+  KernelFactory factories[max_kernel_strings + 1];
+  KernelTable() { KernelFactories<max_kernel_strings>::fill(factories); }
+};
+
+} // namespace
+
+LineSearch *new_kernel_search(Pattern &pattern, const KnotColors &k,
+                              SolutionStore &solutions, bool optimal)
+{
+  static const KernelTable table;
+  const int num_strings = k.num_strings;
+  if (num_strings < 3 || num_strings > max_kernel_strings)
+    return nullptr;
+  return table.factories[num_strings](pattern, k, solutions, optimal);
+}
@@ -0,0 +1,544 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file kernelsearch.h
+   \brief line search specialised for a fixed number of strings
+*/
+
+#ifndef KERNELSEARCH_H
+#define KERNELSEARCH_H
+
+#include "linesearch.h"
+#include <array>
+#include <stdint.h>
+#include <vector>
+
+/// Largest number of strings with a specialised search
+const int max_kernel_strings = 64;
+
+/// Create a search specialised for the number of strings in a pattern
+/**\param pattern the pattern, with start strings and knots set up.
+ * \param k the knot colours to make.
+ * \param solutions solutions are added to this store.
+ * \param optimal only try the pure (or mixed) knots of each line.
+ * \return the search, or \c nullptr if there is no search specialised
+ *  for the number of strings. The caller is responsible for deleting it. */
+LineSearch *new_kernel_search(Pattern &pattern, const KnotColors &k,
+                              SolutionStore &solutions,
+                              bool optimal = false);
+
+/// Count the bits that are set
+inline int bit_count(uint64_t bits)
+{
+#ifdef __GNUC__
+  return __builtin_popcountll(bits);
+#else
+  int cnt = 0;
+  for (; bits; bits &= bits - 1)
+    cnt++;
+  return cnt;
+#endif
+}
+
+/// Get the index of the lowest bit that is set
+inline int lowest_bit(uint64_t bits)
+{
+#ifdef __GNUC__
+  return __builtin_ctzll(bits);
+#else
+  int idx = 0;
+  for (; !(bits & 1); bits >>= 1)
+    idx++;
+  return idx;
+#endif
+}
+
+/// Line search for a fixed number of strings
+/** Equivalent to GenericSearch. The strings are held in fixed size arrays,
+ *  and the knots of a line as the bits of a counter, with the first knot
+ *  in the highest bit, so the loops over the strings and knots have fixed
+ *  lengths and can be unrolled. An odd number of strings has lines of
+ *  equal length, an even number has lines that alternate in length. */
+template <int NS> class KernelSearch : public LineSearch {
+public:
+  /// Strings, as colour indexes
+  typedef std::array<unsigned char, NS> Strings;
+
+  /// Knot colours of a line
+  typedef std::array<unsigned char, NS / 2> Colours;
+
+  enum {
+    knots_even = NS / 2,      ///< number of knots in even lines
+    knots_odd = (NS - 1) / 2, ///< number of knots in odd lines
+    batch_size = 64           ///< number of counter values in a batch
+  };
+
+  /// Search state of a knot line
+  struct LineState {
+    Strings strings_in;  ///< strings entering the line
+    Strings strings_out; ///< strings leaving the line
+    uint64_t cnt;        ///< knots counter
+    uint64_t equal;      ///< knots where both strings are the same colour
+    uint64_t batch;      ///< first counter value of the current batch
+    uint64_t survivors;  ///< counter values of the batch that may be valid
+    uint64_t rejects[2]; ///< counter values of the batch rejected as
+                         ///< redundant, and by colours (with statistics)
+    int cur_score;       ///< score of the lines above
+    int score;           ///< score including this line
+    int phase;           ///< next step to take
+  };
+
+private:
+  std::vector<LineState> stack;
+  std::vector<Colours> colours;
+  std::vector<uint64_t> sol_knots; // packed knots of a solution
+  Strings start_strings;
+
+  static int line_knots(int line)
+  {
+    return (line % 2) ? knots_odd : knots_even;
+  }
+  uint64_t cnt_last(int line) const;
+  int cnt_bit(int line, int knot) const;
+  uint64_t cnt_to_knots(int line, uint64_t cnt) const;
+  uint64_t knots_to_cnt(int line, uint64_t knots) const;
+  uint64_t equal_knots(int line, const Strings &strs) const;
+  uint64_t batch_survivors(int line, const LineState &st,
+                           uint64_t *rejects = nullptr) const;
+  bool next_survivor(int line, LineState &st, uint64_t cnt,
+                     LineStats *ls) const;
+
+  template <int FIRST>
+  static void next_strings(const Strings &in, Strings &out, uint64_t knots);
+  template <int FIRST, bool STATS>
+  bool try_knots(LineState &st, uint64_t knots, const Colours &next_cols,
+                 LineStats *ls);
+  template <bool STATS> bool run_lines(long max_descents);
+
+public:
+  KernelSearch(Pattern &pattern, const KnotColors &k,
+               SolutionStore &solutions, bool optimal = false);
+
+  void start();
+  bool run(long max_descents = -1);
+  Frontier get_frontier() const;
+  void set_frontier(const Frontier &front);
+};
+
+template <int NS>
+KernelSearch<NS>::KernelSearch(Pattern &pattern, const KnotColors &k,
+                               SolutionStore &solutions, bool optimal)
+    : LineSearch(pattern, k, solutions, optimal), stack(k.knots.size()),
+      colours(k.knots.size()), sol_knots(k.knots.size())
+{
+  for (unsigned int i = 0; i < k.knots.size(); i++) {
+    colours[i].fill(0);
+    for (unsigned int j = 0; j < k.knots[i].size(); j++)
+      colours[i][j] = k.knots[i][j];
+  }
+  start();
+}
+
+template <int NS> void KernelSearch<NS>::start()
+{
+  depth = -1;
+  if (stack.empty())
+    return;
+  for (int i = 0; i < NS; i++)
+    start_strings[i] = pat.strings[i];
+  stack[0].strings_in = start_strings;
+  stack[0].cur_score = 0;
+  stack[0].phase = line_enter;
+  depth = 0;
+}
+
+// Final value of the knots counter of a line
+template <int NS> uint64_t KernelSearch<NS>::cnt_last(int line) const
+{
+  int bits = line_knots(line);
+  if (pat.only_symmetric)
+    bits = (bits + 1) / 2; // count through the left half
+  return (uint64_t(1) << bits) - 1;
+}
+
+// Convert the knots counter of a line to knots. If only symmetric then
+// the counter holds the left half, which is copied reversed to the right
+template <int NS>
+uint64_t KernelSearch<NS>::cnt_to_knots(int line, uint64_t cnt) const
+{
+  if (!pat.only_symmetric)
+    return cnt;
+  const int nk = line_knots(line);
+  const int l_cnt = (nk + 1) / 2;
+  const int r_cnt = nk - l_cnt;
+  uint64_t knots = cnt << r_cnt;
+  for (int j = 0; j < r_cnt; j++)
+    knots |= ((cnt >> (l_cnt - r_cnt + j)) & 1) << (r_cnt - 1 - j);
+  return knots;
+}
+
+template <int NS>
+uint64_t KernelSearch<NS>::knots_to_cnt(int line, uint64_t knots) const
+{
+  if (!pat.only_symmetric)
+    return knots;
+  const int nk = line_knots(line);
+  return knots >> (nk - (nk + 1) / 2);
+}
+
+// Bit of the knots counter of a line that holds a knot
+template <int NS> int KernelSearch<NS>::cnt_bit(int line, int knot) const
+{
+  const int nk = line_knots(line);
+  if (!pat.only_symmetric)
+    return nk - 1 - knot;
+  const int l_cnt = (nk + 1) / 2;
+  return (knot < l_cnt) ? l_cnt - 1 - knot : knot - (nk - l_cnt);
+}
+
+// Knots of a line where both strings are the same colour
+template <int NS>
+uint64_t KernelSearch<NS>::equal_knots(int line, const Strings &strs) const
+{
+  const int first = line % 2;
+  const int nk = line_knots(line);
+  uint64_t equal = 0;
+  for (int i = 0; i < nk; i++) {
+    const int idx = first + 2 * i;
+    equal |= uint64_t(strs[idx] == strs[idx + 1]) << (nk - 1 - i);
+  }
+  return equal;
+}
+
+// Pairs of input strings may be switched or left by the knots
+template <int NS>
+template <int FIRST>
+void KernelSearch<NS>::next_strings(const Strings &in, Strings &out,
+                                    uint64_t knots)
+{
+  const int nk = FIRST ? knots_odd : knots_even;
+  if (FIRST)
+    out[0] = in[0];
+  for (int i = 0; i < nk; i++) {
+    const int idx = FIRST + 2 * i;
+    const bool swap = (knots >> (nk - 1 - i)) & 1;
+    out[idx] = swap ? in[idx + 1] : in[idx];
+    out[idx + 1] = swap ? in[idx] : in[idx + 1];
+  }
+  for (int i = FIRST + 2 * nk; i < NS; i++)
+    out[i] = in[i];
+}
+
+// Test the knots for all the counter values of the current batch in
+// parallel. Bit t of a lane word holds the value for counter value
+// batch+t. Return the counter values that are not redundant and whose
+// output strings meet every knot in the next line. The score limit and
+// the wrap are left to try_knots(). If rejects is set it is used to
+// return the counter values rejected as redundant, and by colours
+template <int NS>
+uint64_t KernelSearch<NS>::batch_survivors(int line, const LineState &st,
+                                           uint64_t *rejects) const
+{
+  // lanes for the low bits of a counter
+  static const uint64_t low_lanes[] = {
+      0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+      0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL};
+
+  const int first = line % 2;
+  const int nk = line_knots(line);
+  const int next_line = (line < (int)stack.size() - 1) ? line + 1 : 0;
+  const int next_first = !first;
+  const int next_nk = line_knots(next_line);
+  const Colours &next_cols = colours[next_line];
+  const Strings &in = st.strings_in;
+
+  uint64_t swaps[knots_even]; // lanes for whether each knot swaps strings
+  for (int i = 0; i < nk; i++) {
+    const int bit = cnt_bit(line, i);
+    swaps[i] = (bit < 6) ? low_lanes[bit] : -((st.batch >> bit) & 1);
+  }
+
+  uint64_t valid = ~uint64_t(0);
+  const uint64_t last = cnt_last(line);
+  if (last - st.batch < batch_size - 1)
+    valid = (uint64_t(2) << (last - st.batch)) - 1;
+
+  // only count solutions that don't knot strings of the same colour
+  // with the wrong type
+  const uint64_t in_range = valid;
+  for (int i = 0; i < nk; i++)
+    if ((st.equal >> (nk - 1 - i)) & 1)
+      valid &= pat.prefer_pure ? swaps[i] : ~swaps[i];
+  const uint64_t not_redundant = valid;
+
+  // check each knot in the next line (wrap) is met by at least one
+  // string of the same colour
+  for (int j = 0; j < next_nk && valid; j++) {
+    const int col = next_cols[j];
+    uint64_t met = 0;
+    for (int idx = next_first + 2 * j; idx < next_first + 2 * j + 2; idx++) {
+      const int pr = (idx - first) / 2; // pair of strings for idx
+      if (idx < first || pr >= nk)      // string not knotted in the line
+        met |= -uint64_t(in[idx] == col);
+      else {
+        const int other = (idx == first + 2 * pr) ? idx + 1 : idx - 1;
+        met |= (swaps[pr] & -uint64_t(in[other] == col)) |
+               (~swaps[pr] & -uint64_t(in[idx] == col));
+      }
+    }
+    valid &= met;
+  }
+  if (rejects) {
+    rejects[0] = in_range & ~not_redundant;
+    rejects[1] = not_redundant & ~valid;
+  }
+
+  return valid;
+}
+
+// Set the counter to the first counter value from cnt that may be valid.
+// Return false if there are none. If ls is set the counter values passed
+// over, and the one set, are added to it
+template <int NS>
+bool KernelSearch<NS>::next_survivor(int line, LineState &st, uint64_t cnt,
+                                     LineStats *ls) const
+{
+  const uint64_t last = cnt_last(line);
+  while (cnt <= last) {
+    const uint64_t batch = cnt & ~uint64_t(batch_size - 1);
+    if (batch != st.batch) {
+      st.batch = batch;
+      st.survivors = batch_survivors(line, st, ls ? st.rejects : nullptr);
+    }
+    uint64_t tried = ~uint64_t(0) << (cnt - batch);
+    const uint64_t left = st.survivors & tried;
+    if (left)
+      tried &= (left ^ (left - 1)); // up to the lowest survivor
+    if (ls) {
+      ls->candidates +=
+          bit_count(tried & (st.survivors | st.rejects[0] | st.rejects[1]));
+      ls->redundant += bit_count(tried & st.rejects[0]);
+      ls->colours += bit_count(tried & st.rejects[1]);
+    }
+    if (left) {
+      st.cnt = batch + lowest_bit(left);
+      return true;
+    }
+    cnt = batch + batch_size;
+    if (!cnt) // counter overflowed
+      break;
+  }
+  return false;
+}
+
+// Try the knots of a line. Return whether the strings leaving the line
+// are valid and within the score limit. If STATS is set a reject is
+// added to ls
+template <int NS>
+template <int FIRST, bool STATS>
+bool KernelSearch<NS>::try_knots(LineState &st, uint64_t knots,
+                                 const Colours &next_cols, LineStats *ls)
+{
+  const int nk = FIRST ? knots_odd : knots_even;
+  const int next_first = !FIRST;
+  const int next_nk = next_first ? knots_odd : knots_even;
+
+  // knots that would not be counted in the score
+  const uint64_t pure_knots =
+      pat.prefer_pure ? (uint64_t(1) << nk) - 1 : uint64_t(0);
+  const uint64_t scored_knots = knots ^ pure_knots;
+  // only count solutions that don't knot strings of the same colour
+  // with the wrong type
+  if (scored_knots & st.equal) {
+    if (STATS)
+      ls->redundant++;
+    return false; // redundant solution
+  }
+
+  st.score = st.cur_score + bit_count(scored_knots);
+  const bool over_limit = st.score > pat.score_limit;
+  if (over_limit && !STATS) // with statistics, find whether colours fail
+    return false;
+
+  next_strings<FIRST>(st.strings_in, st.strings_out, knots);
+
+  // check each knot in the next line (wrap) is met by at least one
+  // string of the same colour
+  bool valid = true;
+  for (int i = 0; i < next_nk; i++) {
+    const int idx = next_first + 2 * i;
+    valid &= (next_cols[i] == st.strings_out[idx]) |
+             (next_cols[i] == st.strings_out[idx + 1]);
+  }
+
+  if (STATS) {
+    ls->colours += !valid;
+    ls->score += valid && over_limit;
+  }
+  return valid && !over_limit;
+}
+
+template <int NS> bool KernelSearch<NS>::run(long max_descents)
+{
+  return pat.stats ? run_lines<true>(max_descents)
+                   : run_lines<false>(max_descents);
+}
+
+// The search, with the statistics code only compiled in if STATS is set,
+// to keep it out of the usual search
+template <int NS>
+template <bool STATS>
+bool KernelSearch<NS>::run_lines(long max_descents)
+{
+  const int last_line = (int)stack.size() - 1;
+  long descents = 0;
+  while (depth >= 0) {
+    const int line = depth;
+    const int first = line % 2; // first string that will be knotted
+    LineState &st = stack[line];
+    LineStats *ls = STATS ? &pat.stats->lines[line] : nullptr;
+    if (st.phase == line_enter) {
+      if (max_descents >= 0 && descents >= max_descents)
+        return false; // paused, will descend into this line on resume
+      descents++;
+      pat.count_descent();
+      if (STATS)
+        ls->descents++;
+
+      st.equal = equal_knots(line, st.strings_in);
+      st.phase = line_try;
+      if (try_optimal) { // try pure knots only, or mixed knots only
+        st.cnt = pat.prefer_pure ? cnt_last(line) : 0;
+        if (STATS)
+          ls->candidates++;
+      }
+      else { // start for trying all, skipping those that can't be valid
+        st.batch = ~uint64_t(0);
+        if (!next_survivor(line, st, 0, ls)) {
+          depth--;
+          continue;
+        }
+      }
+    }
+
+    if (st.phase == line_try) {
+      const int next_line = (line < last_line) ? line + 1 : 0;
+      const uint64_t knots = cnt_to_knots(line, st.cnt);
+      bool valid =
+          first ? try_knots<1, STATS>(st, knots, colours[next_line], ls)
+                : try_knots<0, STATS>(st, knots, colours[next_line], ls);
+
+      // Check whether strings match when wrapping to beginning
+      if (valid && !next_line) {
+        valid = (st.strings_out == start_strings);
+        if (STATS && !valid)
+          ls->wrap++;
+      }
+
+      st.phase = line_next;
+      if (valid) {
+        if (next_line) { // descend into the next line
+          LineState &next = stack[next_line];
+          next.strings_in = st.strings_out;
+          next.cur_score = st.score;
+          next.phase = line_enter;
+          depth = next_line;
+          continue;
+        }
+        for (int i = 0; i <= line; i++)
+          sol_knots[i] = cnt_to_knots(i, stack[i].cnt);
+        add_solution(st.score, sol_knots.data());
+        if (pat.stopped) { // finish early
+          depth = -1;
+          break;
+        }
+      }
+    }
+
+    // line_next: move on to the next knots, or return to the line above
+    if (try_optimal || st.cnt == cnt_last(line) ||
+        !next_survivor(line, st, st.cnt + 1, ls))
+      depth--;
+    else
+      st.phase = line_try;
+  }
+
+  return true;
+}
+
+template <int NS>
+LineSearch::Frontier KernelSearch<NS>::get_frontier() const
+{
+  Frontier front;
+  front.strings = pat.strings;
+  front.score_limit = pat.score_limit;
+  front.num_sols = sols.size() - first_sol;
+  front.depth = depth;
+  for (int i = 0; i <= depth; i++) {
+    const int nk = line_knots(i);
+    const uint64_t knots = cnt_to_knots(i, stack[i].cnt);
+    front.phases.push_back(stack[i].phase);
+    front.knots.push_back(std::vector<int>(nk));
+    for (int j = 0; j < nk; j++)
+      front.knots.back()[j] = (knots >> (nk - 1 - j)) & 1;
+  }
+  return front;
+}
+
+template <int NS>
+void KernelSearch<NS>::set_frontier(const Frontier &front)
+{
+  pat.strings = front.strings;
+  pat.score_limit = front.score_limit;
+  first_sol = sols.size() - std::min(front.num_sols, sols.size());
+  start();
+  depth = std::min(front.depth, (int)stack.size() - 1);
+  for (int i = 0; i <= depth; i++) {
+    LineState &st = stack[i];
+    const int nk = line_knots(i);
+    uint64_t knots = 0;
+    for (int j = 0; j < nk; j++)
+      knots = (knots << 1) | (front.knots[i][j] != 0);
+    st.cnt = knots_to_cnt(i, knots);
+    st.phase = front.phases[i];
+    st.equal = equal_knots(i, st.strings_in);
+    st.batch = ~uint64_t(0);
+    if (!try_optimal && st.phase != line_enter) {
+      st.batch = st.cnt & ~uint64_t(batch_size - 1);
+      st.survivors = batch_survivors(i, st, pat.stats ? st.rejects : nullptr);
+    }
+    if (i < depth) { // a line below is in progress, so rebuild its input
+      const uint64_t pure_knots =
+          pat.prefer_pure ? (uint64_t(1) << nk) - 1 : uint64_t(0);
+      st.score = st.cur_score + bit_count(knots ^ pure_knots);
+      if (i % 2)
+        next_strings<1>(st.strings_in, st.strings_out, knots);
+      else
+        next_strings<0>(st.strings_in, st.strings_out, knots);
+      stack[i + 1].strings_in = st.strings_out;
+      stack[i + 1].cur_score = st.score;
+    }
+  }
+}
+
+#endif // KERNELSEARCH_H
@@ -25,6 +25,8 @@
 #include "pattern.h"
 #include "utils.h"
 #include <algorithm>
+#include <chrono>
+#include <limits.h>
 #include <malloc.h>
 
 using std::map;
@@ -134,12 +136,29 @@ Status KnotColors::read(FILE *ifile)
   return stat;
 }
 
+Status KnotColors::read(const vector<string> &lines)
+{
+  vector<string> knot_lines;
+  for (const auto &line : lines) {
+    string data;
+    for (char c : line)
+      if (!isspace(c))
+        data += c;
+    if (data != "")
+      knot_lines.push_back(data);
+  }
+
+  Status stat = check_knot_lines(knot_lines);
+  if (stat.is_ok())
+    process_knots(knot_lines);
+  return stat;
+}
+
 Status KnotColors::read_knot_lines(FILE *ifile, vector<string> &knot_lines)
 {
   int file_line_no = 0; // line number in the file
 
   char *line = 0;
-  int row_num = 0; // first row will be 1
   while (read_line(ifile, &line) == 0) {
     file_line_no++;
     string data;
@@ -148,11 +167,18 @@ Status KnotColors::read_knot_lines(FILE *ifile, vector<string> &knot_lines)
         data += *p;
     free(line);
 
-    if (data == "")
-      continue;
+    if (data != "")
+      knot_lines.push_back(data);
+  }
 
-    row_num++;
-    int num_knots = data.size();
+  return check_knot_lines(knot_lines);
+}
+
+Status KnotColors::check_knot_lines(const vector<string> &knot_lines) const
+{
+  for (unsigned int i = 0; i < knot_lines.size(); i++) {
+    const int row_num = i + 1; // first row will be 1
+    const int num_knots = knot_lines[i].size();
     if (row_num == 1) {
       if (num_knots < 1)
         return Status::error(
@@ -173,8 +199,6 @@ Status KnotColors::read_knot_lines(FILE *ifile, vector<string> &knot_lines)
         return Status::error(msg_str("knot line %d has %d knots, must have %d",
                                      row_num, num_knots, knots));
     }
-
-    knot_lines.push_back(data);
   }
 
   if (knot_lines.size() == 0)
@@ -257,7 +281,7 @@ void KnotColors::print_knots(FILE *file) const
 }
 
 // order through counts of colours that add up to the number of free strings
-static int get_next_cnts(vector<int> &cnts, int free)
+int get_next_cnts(vector<int> &cnts, int free)
 {
   vector<int> sums(cnts.size());
   int sum = 0;
@@ -296,59 +320,195 @@ static int get_next_cnts(vector<int> &cnts, int free)
   return true;
 }
 
-vector<Pattern> KnotColors::solve(bool prefer_pure, bool optimal)
+vector<int> KnotColors::get_start_strings(const vector<int> &free_strings) const
 {
-  vector<Pattern> solns;
-  Pattern pat;
-  pat.set_prefer_pure(prefer_pure);
+  vector<int> strings((num_strings + 1) / 2);
+  int pos = 0;
+  for (int i = 0; i < num_colours; i++) {
+    const int total = free_strings[i] + fixed_strings[i];
+    for (int j = 0; j < total; j++) {
+      strings[pos++] = i;
+    }
+  }
+
+  strings.insert(strings.end(), right.begin(), right.end());
+  std::sort(strings.begin(), strings.end());
+  return strings;
+}
 
+bool KnotColors::get_start_refs(const vector<int> &strings, int *strs_no,
+                                int *perm_no) const
+{
+  vector<int> cnts(num_colours, 0);
+  for (int str : strings)
+    cnts[str]++;
+  vector<int> target(num_colours);
+  for (int i = 0; i < num_colours; i++) {
+    target[i] = cnts[i] - req_colour_cnts[i];
+    if (target[i] < 0)
+      return false;
+  }
+
+  *strs_no = 0;
   vector<int> free_strings(num_colours, 0);
   while (get_next_cnts(free_strings, num_free_strings)) {
-    fprintf(stderr, "\n================================\n");
-    print_cnts(stderr, free_strings, *this, "Free string colour counts");
-
-    vector<int> left((num_strings + 1) / 2);
-    int pos = 0;
-    for (int i = 0; i < num_colours; i++) {
-      const int total = free_strings[i] + fixed_strings[i];
-      for (int j = 0; j < total; j++) {
-        left[pos++] = i;
-      }
+    if (free_strings == target)
+      break;
+    (*strs_no)++;
+    if (num_free_strings == 0)
+      return false;
+  }
+  if (free_strings != target)
+    return false;
+
+  // rank of the permutation, in the lexicographic order made by
+  // next_permutation, counting the permutations that start with a smaller
+  // colour at each position. The partial counts never exceed the count
+  // of the permutations, so stopping when a count passes INT_MAX keeps
+  // every product within a long long.
+  long long rank = 0;
+  for (unsigned int i = 0; i < strings.size(); i++) {
+    for (int col = 0; col < strings[i]; col++) {
+      if (!cnts[col])
+        continue;
+      cnts[col]--;
+      long long perms = 1; // permutations of the remaining strings
+      int n = 0;
+      for (int j = 0; j < num_colours && perms <= INT_MAX; j++)
+        for (int c = 1; c <= cnts[j] && perms <= INT_MAX; c++)
+          perms = perms * (++n) / c;
+      rank += perms;
+      if (rank > INT_MAX)
+        return false; // the number can't be held by a reference
+      cnts[col]++;
     }
+    cnts[strings[i]]--;
+  }
+  *perm_no = (int)rank;
+  return true;
+}
 
-    vector<int> strings = left;
-    strings.insert(strings.end(), right.begin(), right.end());
-    std::sort(strings.begin(), strings.end());
+SolutionStore KnotColors::solve(const SolveOpts &opts)
+{
+  SolutionStore solns;
+  solns.init(*this, opts.prefer_pure);
+  Pattern pat;
+  pat.set_prefer_pure(opts.prefer_pure);
+  pat.only_symmetric = opts.only_symmetric;
+  pat.max_solutions = opts.max_solutions;
+  pat.prove_optimal = opts.prove_optimal;
+  pat.generic_search = opts.generic_search;
+  pat.cancel = opts.cancel;
+  pat.descent_fn = opts.descents ? &opts.descents : nullptr;
+  pat.stats = opts.stats;
+  const auto start_time = std::chrono::steady_clock::now();
+  if (opts.stats)
+    opts.stats->init(knots.size());
 
+  vector<int> free_strings(num_colours, 0);
+  while (get_next_cnts(free_strings, num_free_strings)) {
+    vector<int> strings = get_start_strings(free_strings);
     while (true) {
       pat.set_strings(strings);
-      for (unsigned int j = 0; j < pat.strings.size(); j++)
-        fprintf(stderr, "%c ", get_colour(pat.strings[j]));
-      fprintf(stderr, "\n");
+      if (opts.progress)
+        opts.progress(SolveProgress{pat.soln_strs_no, pat.soln_perm_no,
+                                    free_strings, strings, pat.descent_cnt});
       // if (!pat.only_symmetric || symmetric(strings)) {
-      vector<Pattern> sols = pat.solve(*this, optimal);
-      if (sols.size()) {
-        if (solns.size() == 0 || solns[0].score > sols[0].score)
-          solns = sols;
-        else if (sols[0].score == sols[0].score)
-          solns.insert(solns.end(), sols.begin(), sols.end());
+      // solutions for this permutation are added at the end, and replace
+      // the earlier solutions if they are better
+      const size_t num_solns = solns.size();
+      const int best_score = num_solns ? solns.score(0) : INT_MAX;
+      if (!opts.cache || opts.cache->needs_search(*this, strings)) {
+        const long passed_first =
+            opts.stats && knots.size() > 1 ? opts.stats->lines[1].descents : 0;
+        pat.solve(*this, solns, opts.optimal);
+        if (opts.stats) {
+          opts.stats->permutations++;
+          if (knots.size() > 1 &&
+              opts.stats->lines[1].descents == passed_first)
+            opts.stats->dead_at_first_line++;
+        }
+        if (num_solns && solns.size() > num_solns &&
+            solns.score(num_solns) < solns.score(0))
+          solns.erase_front(num_solns);
+        if (opts.solution) { // a better score replaced the earlier solutions
+          const bool better = solns.size() && solns.score(0) < best_score;
+          for (size_t i = better ? 0 : num_solns; i < solns.size(); i++)
+            opts.solution(solns.get(i));
+        }
+        if (solns.size()) // the limit may be lower if looking for better
+          pat.set_score_limit(std::min(pat.score_limit, solns.score(0)));
       }
-      if (solns.size())
-        pat.set_score_limit(solns[0].score);
       //}
 
-      if (!std::next_permutation(strings.begin(), strings.end()))
+      if (opts.cancel && *opts.cancel)
+        pat.stopped = true;
+      if (pat.stopped ||
+          !std::next_permutation(strings.begin(), strings.end()))
         break;
       pat.increment_perm();
     }
 
     pat.increment_strs();
-    if (num_free_strings == 0)
+    if (pat.stopped || num_free_strings == 0)
       break;
   }
+  if (opts.stats) {
+    opts.stats->seconds = std::chrono::duration<double>(
+                              std::chrono::steady_clock::now() - start_time)
+                              .count();
+    opts.stats->max_rss_kb = peak_rss_kb();
+  }
+  if (opts.descent_total)
+    *opts.descent_total = pat.descent_cnt;
   return solns;
 }
 
+void KnotColors::for_each_start_strings(const StartStringsFunction &fn,
+                                        const ProgressFunction &progress,
+                                        const std::atomic<bool> *cancel) const
+{
+  int strs_no = 0;
+  vector<int> free_strings(num_colours, 0);
+  while (get_next_cnts(free_strings, num_free_strings)) {
+    vector<int> strings = get_start_strings(free_strings);
+    int perm_no = 0;
+    do {
+      if (cancel && *cancel)
+        return;
+      if (progress)
+        progress(SolveProgress{strs_no, perm_no, free_strings, strings, 0});
+      fn(strings, strs_no, perm_no++);
+    } while (std::next_permutation(strings.begin(), strings.end()));
+
+    strs_no++;
+    if (num_free_strings == 0)
+      break;
+  }
+}
+
+ScoreCounts KnotColors::count(const SolveOpts &opts, bool all_scores)
+{
+  ScoreCounts cnts(!all_scores);
+  for_each_start_strings(
+      [&](const vector<int> &strings, int, int) {
+        count_solutions(*this, strings, opts.prefer_pure, opts.only_symmetric,
+                        cnts, all_scores ? INT_MAX : cnts.best_score());
+      },
+      opts.progress, opts.cancel);
+  return cnts;
+}
+
+void KnotColors::solve_zdd(const SolveOpts &opts, ZddStore &store)
+{
+  store.init(*this, opts.prefer_pure);
+  for_each_start_strings(
+      [&](const vector<int> &strings, int strs_no, int perm_no) {
+        store.add(*this, strings, strs_no, perm_no, opts.only_symmetric);
+      },
+      opts.progress);
+}
+
 void print_cnts(FILE *file, const vector<int> &cnts, const KnotColors &k,
                 const string &desc)
 {
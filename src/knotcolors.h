@@ -24,13 +24,74 @@
 #ifndef KNOTCOLORS_H
 #define KNOTCOLORS_H
 
+#include "solutioncount.h"
+#include "solutions.h"
+#include "solvecache.h"
+#include "searchstats.h"
 #include "status.h"
+#include "zddstore.h"
+#include <atomic>
+#include <functional>
 #include <map>
 #include <string>
 #include <vector>
 
 class Pattern;
 
+/// Function called for a set of start strings
+/** It is passed the start strings, the number of the set of free colours
+ *  and the number of the permutation of free colours. */
+typedef std::function<void(const std::vector<int> &, int, int)>
+    StartStringsFunction;
+
+/// Position of a search, reported as each set of start strings is tried
+struct SolveProgress {
+  int strs_no;                          ///< number of the set of free colours
+  int perm_no;                          ///< number of the permutation
+  const std::vector<int> &free_strings; ///< free strings of each colour
+  const std::vector<int> &strings;      ///< start strings
+  long descents; ///< descents of the search so far (0: not searching)
+};
+
+/// Function called as each set of start strings is tried
+typedef std::function<void(const SolveProgress &)> ProgressFunction;
+
+/// Function called every 100000 descents of a search, with the count
+typedef std::function<void(long)> DescentFunction;
+
+/// Function called with each solution found
+/** A solution may be followed by solutions with a better score, which
+ *  replace it. */
+typedef std::function<void(const Pattern &)> SolutionFunction;
+
+/// Options for solving a design
+class SolveOpts {
+public:
+  bool prefer_pure;    ///< find solution with most pure/mixed knots
+  bool only_symmetric; ///< only look for symmetric solutions
+  bool optimal;        ///< only try the pure (or mixed) knots of each line
+  int max_solutions;   ///< stop adding solutions after this many (0: no limit)
+  bool prove_optimal;  ///< after max_solutions, search for better solutions
+  bool generic_search; ///< use the generic search, even for designs that a
+                       ///< faster search applies to (e.g. to check it)
+  SolveCache *cache;   ///< skip start strings known to fail (0: no cache)
+  const std::atomic<bool> *cancel; ///< stop the search when set (0: never)
+  ProgressFunction progress;       ///< report each set of start strings
+  DescentFunction descents;        ///< report the descents of the search
+  SolutionFunction solution;       ///< report each solution found
+  SearchStats *stats;              ///< collect statistics (0: none)
+  long *descent_total; ///< used to return the descents of the search
+                       ///< (0: not returned)
+
+  SolveOpts()
+      : prefer_pure(true), only_symmetric(false), optimal(false),
+        max_solutions(0), prove_optimal(true), generic_search(false),
+        cache(nullptr), cancel(nullptr), stats(nullptr),
+        descent_total(nullptr)
+  {
+  }
+};
+
 class KnotColors {
 public:
   std::vector<std::vector<int>> knots;
@@ -50,6 +111,7 @@ public:
   bool is_symmetric;
 
   Status read_knot_lines(FILE *ifile, std::vector<std::string> &knot_lines);
+  Status check_knot_lines(const std::vector<std::string> &knot_lines) const;
   void process_knots(const std::vector<std::string> &knot_lines);
   char get_colour(int idx) const;
   int get_idx(char col) const;
@@ -57,15 +119,66 @@ public:
 
   Status read(FILE *ifile);
 
+  /// Read the knot colours from lines of text
+  /**\param lines the lines of the design, as in a design file.
+   * \return status, evaluates to \c true if the design is valid. */
+  Status read(const std::vector<std::string> &lines);
+
   int check_perm(int num_lines);
   void get_perm_sections();
   void update_symmetry();
   void print_knots(FILE *file) const;
 
-  std::vector<Pattern> solve(bool prefer_pure, bool optimal);
+  /// Get the start strings for a set of free string colour counts
+  /**\param free_strings the number of free strings of each colour.
+   * \return The start strings, sorted, for the first permutation. */
+  std::vector<int>
+  get_start_strings(const std::vector<int> &free_strings) const;
+
+  /// Get the search position of a set of start strings
+  /** The position is given as the reference numbers used for solutions.
+   * \param strings the start strings.
+   * \param strs_no used to return the number of the set of free colours.
+   * \param perm_no used to return the number of the permutation.
+   * \return \c true if the strings are made in the search, and the number
+   *  of the permutation fits an \c int. */
+  bool get_start_refs(const std::vector<int> &strings, int *strs_no,
+                      int *perm_no) const;
+
+  /// Call a function for each set of start strings, in the search order
+  /**\param fn the function to call for each set of start strings.
+   * \param progress if set, called before \a fn, to report progress.
+   * \param cancel if set, stop when it is set. */
+  void for_each_start_strings(
+      const StartStringsFunction &fn,
+      const ProgressFunction &progress = ProgressFunction(),
+      const std::atomic<bool> *cancel = nullptr) const;
+
+  SolutionStore solve(const SolveOpts &opts);
+
+  /// Count the solutions, without making them
+  /**\param opts the options (the solution limits are not used). If
+   *  the count is cancelled, the counts are of the start strings tried.
+   * \param all_scores count the solutions of every score, rather than
+   *  only those with the best score.
+   * \return The counts. */
+  ScoreCounts count(const SolveOpts &opts, bool all_scores = false);
+
+  /// Find the solutions, storing them as decision diagrams
+  /**\param opts the options (the solution limits are not used).
+   * \param store used to return the solutions. */
+  void solve_zdd(const SolveOpts &opts, ZddStore &store);
 };
 
 void print_cnts(FILE *file, const std::vector<int> &cnts, const KnotColors &k,
                 const std::string &desc);
 bool symmetric(const std::vector<int> &vec);
+
+/// Get the next counts of colours for the free strings
+/** The counts are ordered through all the ways of adding up to the
+ *  number of free strings, starting from all zero counts.
+ * \param cnts the counts of each colour, used to return the next counts.
+ * \param free the number of free strings.
+ * \return \c true if there were next counts, otherwise \c false. */
+int get_next_cnts(std::vector<int> &cnts, int free);
 #endif // KNOTCOLORS_H
@@ -0,0 +1,257 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "linesearch.h"
+#include "kernelsearch.h"
+#include <algorithm>
+
+using std::unique_ptr;
+using std::vector;
+
+LineSearch::LineSearch(Pattern &pattern, const KnotColors &k,
+                       SolutionStore &solutions, bool optimal)
+    : pat(pattern), kc(k), sols(solutions), first_sol(solutions.size()),
+      try_optimal(optimal), depth(-1)
+{
+}
+
+void LineSearch::add_solution(int score, const uint64_t *packed_knots)
+{
+  pat.score = score;
+  if (pat.max_solutions) {
+    add_limited_solution(score, packed_knots);
+    pat.increment_var();
+    return;
+  }
+
+  const bool have_sols = sols.size() > first_sol;
+  if (!have_sols || sols.score(first_sol) >= score) {
+    if (have_sols && sols.score(first_sol) > score) {
+      sols.truncate(first_sol);
+      pat.score_limit = score;
+    }
+    sols.add(pat, score, packed_knots);
+  }
+  pat.increment_var();
+}
+
+// With a limit on the number of solutions, all the solutions in the store
+// have the best score found so far. When the limit is reached either stop,
+// or only search for better solutions.
+void LineSearch::add_limited_solution(int score, const uint64_t *packed_knots)
+{
+  if (sols.size() && sols.score(0) < score)
+    return;
+  if (sols.size() && sols.score(0) > score) {
+    sols.clear();
+    first_sol = 0;
+  }
+
+  pat.score_limit = score;
+  if ((int)sols.size() < pat.max_solutions)
+    sols.add(pat, score, packed_knots);
+  if ((int)sols.size() >= pat.max_solutions) {
+    if (pat.prove_optimal)
+      pat.score_limit = score - 1;
+    else
+      pat.stopped = true;
+  }
+}
+
+unique_ptr<LineSearch> LineSearch::create(Pattern &pattern,
+                                          const KnotColors &k,
+                                          SolutionStore &solutions,
+                                          bool optimal)
+{
+  LineSearch *search = nullptr;
+  if (!pattern.generic_search)
+    search = new_kernel_search(pattern, k, solutions, optimal);
+  if (!search)
+    search = new GenericSearch(pattern, k, solutions, optimal);
+  return unique_ptr<LineSearch>(search);
+}
+
+GenericSearch::GenericSearch(Pattern &pattern, const KnotColors &k,
+                             SolutionStore &solutions, bool optimal)
+    : LineSearch(pattern, k, solutions, optimal), stack(k.knots.size())
+{
+  for (auto &st : stack) {
+    st.strings_in.resize(k.num_strings);
+    st.strings_out.resize(k.num_strings);
+  }
+  half.reserve(k.num_strings);
+  start();
+}
+
+void GenericSearch::start()
+{
+  depth = -1;
+  if (stack.empty())
+    return;
+  stack[0].strings_in = pat.strings;
+  stack[0].cur_score = 0;
+  stack[0].phase = line_enter;
+  depth = 0;
+}
+
+bool GenericSearch::next_knots(int line)
+{
+  vector<int> &knots = pat.knots[line];
+  if (!pat.only_symmetric)
+    return increment(knots);
+
+  // increment the left half and copy it reversed to the right half
+  const int l_cnt = (knots.size() + 1) / 2;
+  const int r_cnt = knots.size() - l_cnt;
+  half.assign(knots.begin(), knots.begin() + l_cnt);
+  if (!increment(half))
+    return false;
+  std::copy(half.begin(), half.end(), knots.begin());
+  std::copy(half.rbegin() + (l_cnt - r_cnt), half.rend(),
+            knots.begin() + l_cnt);
+  return true;
+}
+
+bool GenericSearch::run(long max_descents)
+{
+  const int last_line = (int)stack.size() - 1;
+  long descents = 0;
+  while (depth >= 0) {
+    const int line = depth;
+    LineState &st = stack[line];
+    LineStats *ls = pat.stats ? &pat.stats->lines[line] : nullptr;
+    if (st.phase == line_enter) {
+      if (max_descents >= 0 && descents >= max_descents)
+        return false; // paused, will descend into this line on resume
+      descents++;
+      pat.count_descent();
+      if (ls)
+        ls->descents++;
+
+      // knots is effectively a binary number
+      vector<int> &knots = pat.knots[line];
+      if (try_optimal && pat.prefer_pure)    // try pure knots only
+        fill(knots.begin(), knots.end(), 1); // 11...11
+      else // start for trying all or try mixed knots only
+        fill(knots.begin(), knots.end(), 0); // 00...00
+      st.phase = line_try;
+    }
+
+    if (st.phase == line_try) {
+      // Pairs of input strings may be switched or left by the knots
+      const int first = line % 2; // first string that will be knotted
+      int line_score;
+      get_next_strings(st.strings_in, pat.knots[line], first, st.strings_out,
+                       pat.prefer_pure, &line_score);
+      st.score = st.cur_score + line_score;
+      bool valid = (line_score >= 0);
+      if (ls) {
+        ls->candidates++;
+        ls->redundant += !valid;
+      }
+
+      // check each knot in the next line (wrap) is met by at least one
+      // string of the same colour
+      const int next_line = (line < last_line) ? line + 1 : 0;
+      if (valid && !knots_met(kc.knots[next_line], st.strings_out, !first)) {
+        valid = false;
+        if (ls)
+          ls->colours++;
+      }
+
+      if (valid && st.score > pat.score_limit) {
+        valid = false;
+        if (ls)
+          ls->score++;
+      }
+
+      // Check whether strings match when wrapping to beginning
+      if (valid && !next_line) {
+        valid = (st.strings_out == pat.strings);
+        if (ls && !valid)
+          ls->wrap++;
+      }
+
+      st.phase = line_next;
+      if (valid) {
+        if (next_line) { // descend into the next line
+          LineState &next = stack[next_line];
+          next.strings_in = st.strings_out;
+          next.cur_score = st.score;
+          next.phase = line_enter;
+          depth = next_line;
+          continue;
+        }
+        add_solution(st.score);
+        if (pat.stopped) { // finish early
+          depth = -1;
+          break;
+        }
+      }
+    }
+
+    // line_next: move on to the next knots, or return to the line above
+    if (try_optimal || !next_knots(line)) // only need to test each line once
+      depth--;
+    else
+      st.phase = line_try;
+  }
+
+  return true;
+}
+
+LineSearch::Frontier GenericSearch::get_frontier() const
+{
+  Frontier front;
+  front.strings = pat.strings;
+  front.score_limit = pat.score_limit;
+  front.num_sols = sols.size() - first_sol;
+  front.depth = depth;
+  for (int i = 0; i <= depth; i++) {
+    front.phases.push_back(stack[i].phase);
+    front.knots.push_back(pat.knots[i]);
+  }
+  return front;
+}
+
+void GenericSearch::set_frontier(const Frontier &front)
+{
+  pat.strings = front.strings;
+  pat.score_limit = front.score_limit;
+  first_sol = sols.size() - std::min(front.num_sols, sols.size());
+  start();
+  depth = std::min(front.depth, (int)stack.size() - 1);
+  for (int i = 0; i <= depth; i++) {
+    LineState &st = stack[i];
+    st.phase = front.phases[i];
+    pat.knots[i] = front.knots[i];
+    if (i < depth) { // a line below is in progress, so rebuild its input
+      int line_score;
+      get_next_strings(st.strings_in, pat.knots[i], i % 2, st.strings_out,
+                       pat.prefer_pure, &line_score);
+      st.score = st.cur_score + line_score;
+      stack[i + 1].strings_in = st.strings_out;
+      stack[i + 1].cur_score = st.score;
+    }
+  }
+}
@@ -0,0 +1,152 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file linesearch.h
+   \brief iterative, resumable search of the knot lines of a pattern
+*/
+
+#ifndef LINESEARCH_H
+#define LINESEARCH_H
+
+#include "knotcolors.h"
+#include "pattern.h"
+#include "searchstats.h"
+#include "solutions.h"
+#include <memory>
+#include <vector>
+
+/// Iterative search for the knots of a pattern
+/** Equivalent to Pattern::check_line, but the state of each knot line is
+ *  held on an explicit, preallocated stack rather than in recursive calls.
+ *  The search can be paused after a number of descents and resumed, and
+ *  its frontier can be read and set, to save or divide the remaining work.
+ *  Use create() to get the search best suited to the pattern. */
+class LineSearch {
+public:
+  /// The next step to take for a line
+  enum { line_enter = 0, line_try, line_next };
+
+  /// Frontier of a search, sufficient to resume it
+  struct Frontier {
+    std::vector<int> strings;            ///< start strings
+    int score_limit;                     ///< current score limit
+    size_t num_sols;                     ///< solutions added to the store
+    int depth;                           ///< current line, -1 when finished
+    std::vector<int> phases;             ///< phase of each line to depth
+    std::vector<std::vector<int>> knots; ///< knots of each line to depth
+  };
+
+protected:
+  Pattern &pat;
+  const KnotColors &kc;
+  SolutionStore &sols;
+  size_t first_sol; // index in sols of the first solution of this search
+  bool try_optimal;
+  int depth;
+
+  void add_solution(int score, const uint64_t *packed_knots = nullptr);
+  void add_limited_solution(int score, const uint64_t *packed_knots);
+
+public:
+  /// Constructor
+  /**\param pattern the pattern, with start strings and knots set up,
+   *  which will be modified during the search.
+   * \param k the knot colours to make.
+   * \param solutions solutions are added to this store, if they are
+   *  as good as any already added by this search.
+   * \param optimal only try the pure (or mixed) knots of each line. */
+  LineSearch(Pattern &pattern, const KnotColors &k,
+             SolutionStore &solutions, bool optimal = false);
+
+  /// Destructor
+  virtual ~LineSearch() = default;
+
+  /// Start, or restart, the search from the pattern start strings
+  virtual void start() = 0;
+
+  /// Run the search
+  /**\param max_descents pause before making more than this number of
+   *  descents, or run to completion if negative.
+   * \return \c true if the search finished, \c false if it was paused. */
+  virtual bool run(long max_descents = -1) = 0;
+
+  /// Check whether the search has finished
+  /**\return \c true if finished, otherwise \c false. */
+  bool finished() const { return depth < 0; }
+
+  /// Get the frontier of the search
+  /**\return the frontier. */
+  virtual Frontier get_frontier() const = 0;
+
+  /// Set the frontier of the search
+  /** The remaining work is rebuilt from the frontier. The last
+   *  \c num_sols solutions in the store are taken to be those found
+   *  so far by the search.
+   * \param front the frontier to resume from. */
+  virtual void set_frontier(const Frontier &front) = 0;
+
+  /// Create a search
+  /** A search specialised for the number of strings is used if one is
+   *  available, and the pattern doesn't ask for the generic search,
+   *  otherwise a GenericSearch.
+   * \param pattern the pattern, with start strings and knots set up.
+   * \param k the knot colours to make.
+   * \param solutions solutions are added to this store, if they are
+   *  as good as any already added by this search.
+   * \param optimal only try the pure (or mixed) knots of each line.
+   * \return the search. */
+  static std::unique_ptr<LineSearch> create(Pattern &pattern,
+                                            const KnotColors &k,
+                                            SolutionStore &solutions,
+                                            bool optimal = false);
+};
+
+/// Line search for any number of strings
+class GenericSearch : public LineSearch {
+public:
+  /// Search state of a knot line
+  struct LineState {
+    std::vector<int> strings_in;  ///< strings entering the line
+    std::vector<int> strings_out; ///< strings leaving the line
+    int cur_score;                ///< score of the lines above
+    int score;                    ///< score including this line
+    int phase;                    ///< next step to take
+  };
+
+private:
+  std::vector<LineState> stack;
+  std::vector<int> half; // working space for symmetric knots
+
+  bool next_knots(int line);
+
+public:
+  GenericSearch(Pattern &pattern, const KnotColors &k,
+                SolutionStore &solutions, bool optimal = false);
+
+  void start();
+  bool run(long max_descents = -1);
+  Frontier get_frontier() const;
+  void set_frontier(const Frontier &front);
+};
+
+#endif // LINESEARCH_H
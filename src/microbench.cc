@@ -0,0 +1,290 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file microbench.cc
+   \brief micro-benchmarks of the inner operations of the search
+*/
+
+#include "knotcolors.h"
+#include "pattern.h"
+#include "programopts.h"
+#include "utils.h"
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+class MbOpts : public ProgramOpts {
+public:
+  int reps;
+  int warmups;
+  int ops;
+  string filter;
+
+  MbOpts() : ProgramOpts("microbench"), reps(10), warmups(2), ops(1000000)
+  {
+  }
+  void process_cmd_line(int argc, char **argv);
+  void usage();
+};
+
+void MbOpts::usage()
+{
+  fprintf(stdout,
+          "\n"
+          "Usage: %s [options] [name]\n"
+          "\n"
+          "Time the inner operations of the bracelet_solver search, for\n"
+          "several numbers of strings, and report the nanoseconds per\n"
+          "operation. Each benchmark is run for some warm-up repetitions,\n"
+          "then timed over repetitions of a number of operations, and the\n"
+          "mean, standard deviation and minimum of the repetitions are\n"
+          "reported. If name is given then only the benchmarks whose\n"
+          "names contain it are run.\n"
+          "\n"
+          "Options\n"
+          "  -h         print this help text\n"
+          "  -v         print the program version and licence\n"
+          "  -r <n>     number of timed repetitions (default: 10)\n"
+          "  -w <n>     number of warm-up repetitions (default: 2)\n"
+          "  -n <n>     number of operations in a repetition "
+          "(default: 1000000)\n"
+          "\n",
+          prog_name());
+}
+
+void MbOpts::process_cmd_line(int argc, char **argv)
+{
+  opterr = 0;
+  int c;
+
+  handle_long_opts(argc, argv);
+
+  while ((c = getopt(argc, argv, ":hvr:w:n:")) != -1) {
+    if (common_opts(c, optopt))
+      continue;
+
+    switch (c) {
+    case 'r':
+      print_status_or_exit(read_int(optarg, &reps), c);
+      if (reps < 2)
+        error("number of repetitions must be 2 or more", c);
+      break;
+
+    case 'w':
+      print_status_or_exit(read_int(optarg, &warmups), c);
+      if (warmups < 0)
+        error("number of repetitions cannot be negative", c);
+      break;
+
+    case 'n':
+      print_status_or_exit(read_int(optarg, &ops), c);
+      if (ops < 1)
+        error("number of operations must be 1 or more", c);
+      break;
+
+    default:
+      error("unknown command line error");
+    }
+  }
+
+  if (argc - optind > 1)
+    error("more than one benchmark name given");
+  if (argc - optind == 1)
+    filter = argv[optind];
+}
+
+// Numbers of strings to run each benchmark for
+const int widths[] = {8, 12, 16, 24, 32};
+
+// Number of colours in the generated strings and knots
+const int num_colours = 3;
+
+// Number of inputs prepared for a benchmark, used in turn
+const int pool_size = 256;
+
+// Results of the operations are accumulated here, so they can't be
+// optimised away
+volatile long bench_sink;
+
+// Time an operation. The operation takes the index of the operation and
+// returns a value to accumulate
+template <typename Op>
+void run_bench(const MbOpts &opts, const string &name, int width, Op op)
+{
+  if (name.find(opts.filter) == string::npos)
+    return;
+
+  long sink = 0;
+  vector<double> ns_per_op;
+  for (int rep = 0; rep < opts.warmups + opts.reps; rep++) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < opts.ops; i++)
+      sink += op(i);
+    const auto end = std::chrono::steady_clock::now();
+    bench_sink = sink;
+    if (rep >= opts.warmups)
+      ns_per_op.push_back(std::chrono::duration<double, std::nano>(end - start)
+                              .count() /
+                          opts.ops);
+  }
+
+  double mean = 0;
+  for (double ns : ns_per_op)
+    mean += ns;
+  mean /= ns_per_op.size();
+  double var = 0;
+  for (double ns : ns_per_op)
+    var += (ns - mean) * (ns - mean);
+  var /= ns_per_op.size() - 1;
+  const double min = *std::min_element(ns_per_op.begin(), ns_per_op.end());
+
+  fprintf(stdout, "%-20s %5d %10.2f %8.2f %6.1f%% %10.2f\n", name.c_str(),
+          width, mean, sqrt(var), mean > 0 ? 100 * sqrt(var) / mean : 0.0,
+          min);
+}
+
+vector<int> random_colours(std::mt19937 &rng, int cnt)
+{
+  std::uniform_int_distribution<int> col(0, num_colours - 1);
+  vector<int> cols(cnt);
+  for (auto &c : cols)
+    c = col(rng);
+  return cols;
+}
+
+// The strings leaving a line, for random strings and knots
+void bench_next_strings(const MbOpts &opts, int width, std::mt19937 &rng)
+{
+  vector<vector<int>> strings(pool_size);
+  vector<vector<int>> knots(pool_size);
+  std::uniform_int_distribution<int> bit(0, 1);
+  for (int i = 0; i < pool_size; i++) {
+    strings[i] = random_colours(rng, width);
+    knots[i].resize(width / 2);
+    for (auto &k : knots[i])
+      k = bit(rng);
+  }
+  vector<int> strings_out(width);
+  run_bench(opts, "get_next_strings", width, [&](int i) {
+    const int idx = i % pool_size;
+    int line_score;
+    get_next_strings(strings[idx], knots[idx], 0, strings_out, true,
+                     &line_score);
+    return line_score + strings_out[idx % width];
+  });
+}
+
+// Counting through the knots of a line
+void bench_increment(const MbOpts &opts, int width)
+{
+  vector<int> digits(width / 2, 0);
+  run_bench(opts, "increment", width, [&](int) {
+    if (increment(digits))
+      return digits.back();
+    std::fill(digits.begin(), digits.end(), 0);
+    return 0;
+  });
+}
+
+// Whether the strings leaving a line meet the knot colours of the next
+// line, as checked for each knotting in the search. About half the
+// strings pass, and the rest fail at a random knot
+void bench_knots_met(const MbOpts &opts, int width, std::mt19937 &rng)
+{
+  const int nk = (width - 1) / 2; // knots of the next line, offset 1
+  vector<vector<int>> strings(pool_size);
+  vector<vector<int>> knot_cols(pool_size);
+  std::uniform_int_distribution<int> knot(0, nk - 1);
+  std::uniform_int_distribution<int> pick(0, 1);
+  for (int i = 0; i < pool_size; i++) {
+    strings[i] = random_colours(rng, width);
+    knot_cols[i].resize(nk);
+    for (int j = 0; j < nk; j++)
+      knot_cols[i][j] = strings[i][1 + 2 * j + pick(rng)];
+    if (i % 2) { // make a knot that isn't met
+      const int j = knot(rng);
+      const int a = strings[i][1 + 2 * j];
+      const int b = strings[i][2 + 2 * j];
+      for (int c = 0; c < num_colours; c++)
+        if (c != a && c != b)
+          knot_cols[i][j] = c;
+    }
+  }
+  run_bench(opts, "knots_met", width, [&](int i) {
+    const int idx = i % pool_size;
+    return (int)knots_met(knot_cols[idx], strings[idx], 1);
+  });
+}
+
+// Counting through the colours of the free strings
+void bench_next_cnts(const MbOpts &opts, int width)
+{
+  vector<int> cnts(num_colours, 0);
+  const int free = width / 4;
+  run_bench(opts, "get_next_cnts", width, [&](int) {
+    if (get_next_cnts(cnts, free))
+      return cnts[0];
+    std::fill(cnts.begin(), cnts.end(), 0);
+    return 0;
+  });
+}
+
+// Permuting the start strings
+void bench_next_permutation(const MbOpts &opts, int width, std::mt19937 &rng)
+{
+  vector<int> strings = random_colours(rng, width);
+  std::sort(strings.begin(), strings.end());
+  run_bench(opts, "next_permutation", width, [&](int) {
+    if (std::next_permutation(strings.begin(), strings.end()))
+      return strings[0];
+    return 0; // wrapped back to the sorted strings
+  });
+}
+
+int main(int argc, char **argv)
+{
+  MbOpts opts;
+  opts.process_cmd_line(argc, argv);
+
+  fprintf(stdout, "%-20s %5s %10s %8s %7s %10s\n", "benchmark", "width",
+          "ns/op", "stddev", "cv", "min");
+  std::mt19937 rng(1);
+  for (int width : widths)
+    bench_next_strings(opts, width, rng);
+  for (int width : widths)
+    bench_increment(opts, width);
+  for (int width : widths)
+    bench_knots_met(opts, width, rng);
+  for (int width : widths)
+    bench_next_cnts(opts, width);
+  for (int width : widths)
+    bench_next_permutation(opts, width, rng);
+
+  return 0;
+}
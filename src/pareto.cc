@@ -0,0 +1,262 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "pareto.h"
+#include "solutioncount.h"
+#include <algorithm>
+#include <limits.h>
+#include <string>
+#include <unordered_map>
+
+using std::string;
+using std::vector;
+
+static bool less(const ParetoSearch::Point &a, const ParetoSearch::Point &b)
+{
+  return a.pure_score < b.pure_score ||
+         (a.pure_score == b.pure_score && a.mixed_score < b.mixed_score);
+}
+
+// a point beats another if it is better on both scores
+static bool beats(const ParetoSearch::Point &a, const ParetoSearch::Point &b)
+{
+  return a.pure_score < b.pure_score && a.mixed_score < b.mixed_score;
+}
+
+static bool beaten(const vector<ParetoSearch::Point> &pts,
+                   const ParetoSearch::Point &pt)
+{
+  for (const auto &p : pts)
+    if (beats(p, pt))
+      return true;
+  return false;
+}
+
+// Add a point to a sorted set of points that are not beaten, removing any
+// points that it beats
+static void add_point(vector<ParetoSearch::Point> &pts,
+                      const ParetoSearch::Point &pt)
+{
+  if (beaten(pts, pt))
+    return;
+  pts.erase(std::remove_if(pts.begin(), pts.end(),
+                           [&](const ParetoSearch::Point &p) {
+                             return beats(pt, p);
+                           }),
+            pts.end());
+  auto pos = std::lower_bound(pts.begin(), pts.end(), pt, less);
+  if (pos == pts.end() || less(pt, *pos))
+    pts.insert(pos, pt);
+}
+
+ParetoSearch::ParetoSearch(const KnotColors &k) : kc(k)
+{
+  pure_sols.init(k, true);
+  mixed_sols.init(k, false);
+  pat.set_prefer_pure(true);
+  pat.knots.resize(k.knots.size());
+  for (unsigned int i = 0; i < k.knots.size(); i++)
+    pat.knots[i].resize(k.knots[i].size());
+  strs.resize(k.knots.size());
+  transitions.resize(k.knots.size());
+  bounds.resize(k.knots.size());
+}
+
+// Score of the knots of a line when preferring mixed knots
+static int mixed_line_score(const vector<int> &strings_in,
+                            const vector<int> &knots, int first)
+{
+  // the pure knots between strings of different colours
+  int score = 0;
+  for (unsigned int j = 0; j < knots.size(); j++) {
+    const int idx = first + 2 * j;
+    score += knots[j] && strings_in[idx] != strings_in[idx + 1];
+  }
+  return score;
+}
+
+void ParetoSearch::add_solution(int pure_score, int mixed_score)
+{
+  if (!pure_sols.size() || pure_score <= pure_sols.score(0)) {
+    if (pure_sols.size() && pure_score < pure_sols.score(0))
+      pure_sols.clear();
+    pure_sols.add(pat, pure_score);
+  }
+
+  if (!mixed_sols.size() || mixed_score <= mixed_sols.score(0)) {
+    if (mixed_sols.size() && mixed_score < mixed_sols.score(0))
+      mixed_sols.clear();
+    // knots between strings of the same colour don't swap them
+    Pattern mixed_pat = pat;
+    mixed_pat.set_prefer_pure(false);
+    for (unsigned int i = 0; i < pat.knots.size(); i++) {
+      const int first = i % 2;
+      for (unsigned int j = 0; j < pat.knots[i].size(); j++)
+        if (strs[i][first + 2 * j] == strs[i][first + 2 * j + 1])
+          mixed_pat.knots[i][j] = 0;
+    }
+    mixed_sols.add(mixed_pat, mixed_score);
+  }
+
+  pat.increment_var();
+}
+
+// The valid knottings of a line are found once for each set of strings
+// entering the line, and used by both the search and the front
+const vector<ParetoSearch::Transition> &
+ParetoSearch::get_transitions(int line, const string &key)
+{
+  auto it = transitions[line].find(key);
+  if (it != transitions[line].end())
+    return it->second;
+
+  vector<Transition> &trans = transitions[line][key];
+  const vector<int> strings_in(key.begin(), key.end());
+  const int first = line % 2; // first string that will be knotted
+  auto add_trans = [&](const vector<int> &knots, const vector<int> &str_out,
+                       int line_score) {
+    const Transition tr = {knots, string(str_out.begin(), str_out.end()),
+                           line_score,
+                           mixed_line_score(strings_in, knots, first)};
+    trans.push_back(tr);
+  };
+  for_each_line_knots(kc, line, strings_in, pat.strings, true, false,
+                      add_trans);
+  return trans;
+}
+
+// Lowest pure and mixed scores of the lines from line to the last line,
+// for solutions with the strings entering the line. INT_MAX if there are
+// no solutions
+const ParetoSearch::Point &ParetoSearch::get_bound(int line, const string &key)
+{
+  if (line == (int)kc.knots.size()) {
+    static const Point none = {INT_MAX, INT_MAX};
+    static const Point zero = {0, 0};
+    return (key == strs[0]) ? zero : none;
+  }
+
+  auto it = bounds[line].find(key);
+  if (it != bounds[line].end())
+    return it->second;
+
+  Point bound = {INT_MAX, INT_MAX};
+  for (const auto &tr : get_transitions(line, key)) {
+    const Point next = get_bound(line + 1, tr.strings_out);
+    if (next.pure_score != INT_MAX) {
+      bound.pure_score =
+          std::min(bound.pure_score, tr.pure_score + next.pure_score);
+      bound.mixed_score =
+          std::min(bound.mixed_score, tr.mixed_score + next.mixed_score);
+    }
+  }
+  return bounds[line][key] = bound;
+}
+
+void ParetoSearch::check_line(int line, int pure_score, int mixed_score)
+{
+  pat.count_descent();
+  const bool last_line = (line == (int)kc.knots.size() - 1);
+  for (const auto &tr : get_transitions(line, strs[line])) {
+    const int pure = pure_score + tr.pure_score;
+    const int mixed = mixed_score + tr.mixed_score;
+    const Point &rest = get_bound(line + 1, tr.strings_out);
+    if (rest.pure_score == INT_MAX) // can't lead to a solution
+      continue;
+    if (pure_sols.size() && pure + rest.pure_score > pure_sols.score(0) &&
+        mixed + rest.mixed_score > mixed_sols.score(0))
+      continue;
+
+    pat.knots[line] = tr.knots;
+    if (last_line)
+      add_solution(pure, mixed);
+    else {
+      strs[line + 1] = tr.strings_out;
+      check_line(line + 1, pure, mixed);
+    }
+  }
+}
+
+// Find the scores of the solutions that are not beaten, line by line. The
+// knottings that lead to the same strings at the end of a line are merged
+// into a single state, holding the scores that are not beaten
+void ParetoSearch::add_front()
+{
+  std::unordered_map<string, vector<Point>> states, next_states;
+  states[strs[0]].push_back({0, 0});
+  for (int line = 0; line < (int)kc.knots.size() && !states.empty(); line++) {
+    next_states.clear();
+    for (const auto &kp : states) {
+      for (const auto &tr : get_transitions(line, kp.first)) {
+        const Point &rest = get_bound(line + 1, tr.strings_out);
+        if (rest.pure_score == INT_MAX) // can't lead to a solution
+          continue;
+        vector<Point> *pts = nullptr;
+        for (const auto &pt : kp.second) {
+          const Point next = {pt.pure_score + tr.pure_score,
+                              pt.mixed_score + tr.mixed_score};
+          const Point lowest = {next.pure_score + rest.pure_score,
+                                next.mixed_score + rest.mixed_score};
+          if (beaten(front, lowest))
+            continue;
+          if (!pts)
+            pts = &next_states[tr.strings_out];
+          add_point(*pts, next);
+        }
+      }
+    }
+    states.swap(next_states);
+  }
+
+  // the only state left has the start strings
+  for (const auto &kp : states)
+    for (const auto &pt : kp.second)
+      add_point(front, pt);
+}
+
+void ParetoSearch::add_strings(const vector<int> &strings, int strs_no,
+                               int perm_no)
+{
+  pat.set_strings(strings);
+  pat.soln_strs_no = strs_no;
+  pat.soln_perm_no = perm_no;
+  pat.soln_var_no = 0;
+  strs[0].assign(strings.begin(), strings.end());
+  // the knottings of the last line, and the bounds, depend on the start
+  // strings
+  transitions.back().clear();
+  for (auto &line_bounds : bounds)
+    line_bounds.clear();
+  check_line(0, 0, 0);
+  add_front();
+}
+
+vector<ParetoSearch::Point> ParetoSearch::get_front() const
+{
+  // remove points with a score that is equalled by a better point
+  vector<Point> pts;
+  for (const auto &pt : front)
+    if (pts.empty() || pt.mixed_score < pts.back().mixed_score)
+      pts.push_back(pt);
+  return pts;
+}
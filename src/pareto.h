@@ -0,0 +1,115 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file pareto.h
+   \brief single search for the solutions preferring pure and mixed knots
+*/
+
+#ifndef PARETO_H
+#define PARETO_H
+
+#include "knotcolors.h"
+#include "pattern.h"
+#include "solutions.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// Search for the best solutions preferring pure knots and mixed knots
+/** A knotting only has a choice of knot where the two strings have
+ *  different colours, where a pure knot swaps them and a mixed knot
+ *  doesn't. The other knots swap the strings when preferring pure knots,
+ *  and don't when preferring mixed knots, and so each knotting has a pure
+ *  score (number of mixed choices) and a mixed score (number of pure
+ *  choices). The knottings of each set of start strings are searched
+ *  once for both kinds of best solution, abandoning a partial knotting
+ *  only when both its scores are worse than the best found. The Pareto
+ *  front of the scores is found line by line from merged states, as in
+ *  count_solutions(). Symmetric solutions are not supported, as a
+ *  symmetric knotting preferring pure knots may not correspond to a
+ *  symmetric knotting preferring mixed knots. */
+class ParetoSearch {
+public:
+  /// Scores of a solution
+  struct Point {
+    int pure_score;  ///< score when preferring pure knots
+    int mixed_score; ///< score when preferring mixed knots
+  };
+
+private:
+  /// Valid knotting of a line for a set of strings entering the line
+  struct Transition {
+    std::vector<int> knots;  // knots, preferring pure knots
+    std::string strings_out; // strings leaving the line
+    int pure_score;          // score preferring pure knots
+    int mixed_score;         // score preferring mixed knots
+  };
+
+  const KnotColors &kc;
+  std::vector<std::unordered_map<std::string, std::vector<Transition>>>
+      transitions; // for each line, by strings entering the line
+  std::vector<std::unordered_map<std::string, Point>>
+      bounds; // lowest scores to complete a solution from a line
+  Pattern pat;                        // knots preferring pure knots
+  std::vector<std::string> strs;      // strings entering each line
+  std::vector<Point> front; // scores not beaten on both scores
+  SolutionStore pure_sols;
+  SolutionStore mixed_sols;
+
+  const std::vector<Transition> &get_transitions(int line,
+                                                 const std::string &key);
+  const Point &get_bound(int line, const std::string &key);
+  void add_solution(int pure_score, int mixed_score);
+  void check_line(int line, int pure_score, int mixed_score);
+  void add_front();
+
+public:
+  /// Constructor
+  /**\param k the design. */
+  ParetoSearch(const KnotColors &k);
+
+  /// Search the knottings of a set of start strings
+  /**\param strings the start strings.
+   * \param strs_no the set of free colours.
+   * \param perm_no the permutation of free colours. */
+  void add_strings(const std::vector<int> &strings, int strs_no, int perm_no);
+
+  /// Set a function to report the descents of the search
+  /**\param fn the function, which must outlive the search, or \c nullptr
+   *  for no reports. */
+  void set_descent_function(const DescentFunction *fn) { pat.descent_fn = fn; }
+
+  /// Get the Pareto front of the scores
+  /**\return The scores of the solutions that no other solution equals
+   *  or beats on both scores, ordered by increasing pure score. */
+  std::vector<Point> get_front() const;
+
+  /// Get the best solutions preferring pure knots
+  /**\return The solutions. */
+  const SolutionStore &get_pure_solutions() const { return pure_sols; }
+
+  /// Get the best solutions preferring mixed knots
+  /**\return The solutions. */
+  const SolutionStore &get_mixed_solutions() const { return mixed_sols; }
+};
+
+#endif // PARETO_H
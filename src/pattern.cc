@@ -22,6 +22,7 @@
 */
 
 #include "pattern.h"
+#include "linesearch.h"
 #include "utils.h"
 #include <limits.h>
 #include <stdio.h>
@@ -30,17 +31,22 @@ using std::vector;
 using std::string;
 using std::map;
 
-vector<int> get_next_strings(const vector<int> &strings_in,
-                             const vector<int> &knots, int offset,
-                             bool prefer_pure = true, int *line_score = 0);
-int increment(vector<int> &digits);
-
 Pattern::Pattern()
     : soln_no(0), soln_strs_no(0), soln_perm_no(0), soln_var_no(0),
-      score(INT_MAX), score_limit(INT_MAX), prefer_pure(true), descent_cnt(0)
+      score(INT_MAX), score_limit(INT_MAX), prefer_pure(true),
+      only_symmetric(false), max_solutions(0), prove_optimal(true),
+      generic_search(false), stopped(false), cancel(nullptr),
+      descent_fn(nullptr), stats(nullptr), descent_cnt(0)
 {
 }
 
+void Pattern::count_descent()
+{
+  descent_cnt++;
+  if (descent_fn && descent_cnt % 100000 == 0)
+    (*descent_fn)(descent_cnt);
+}
+
 void Pattern::print_strings_and_knots(const KnotColors &k, FILE *file) const
 {
   vector<int> str = strings;
@@ -67,10 +73,17 @@ void Pattern::print_strings_and_knots(const KnotColors &k, FILE *file) const
 
 void Pattern::print_generator_pattern(const KnotColors &k, FILE *file) const
 {
-  vector<int> str = strings;
-  for (unsigned int i = 0; i < str.size(); i++)
-    fprintf(file, "%c ", k.get_colour(str[i]));
+  for (unsigned int i = 0; i < strings.size(); i++)
+    fprintf(file, "%c ", k.get_colour(strings[i]));
   fprintf(file, "\n\n");
+  for (const auto &knot_types : get_generator_knots(k))
+    fprintf(file, "%s\n", knot_types.c_str());
+}
+
+vector<string> Pattern::get_generator_knots(const KnotColors &k) const
+{
+  vector<string> lines(k.knots.size());
+  vector<int> str = strings;
   for (unsigned int i = 0; i < k.knots.size(); i++) {
     int offset = i % 2;
     const vector<int> &knts = knots[i];
@@ -98,11 +111,11 @@ void Pattern::print_generator_pattern(const KnotColors &k, FILE *file) const
       //      idx, knot_types[idx]);
       // fprintf(stdout,"[%d,%d](%d,%d) = (%d,%d [%d] %d,%d)\n", i, j,
       // 2*j+offset, 2*j+offset+1, TL, TR, K, BL, BR);
-      fprintf(file, "%c", knot_types[idx]);
+      lines[i] += knot_types[idx];
     }
     str = str_next;
-    fprintf(file, "\n");
   }
+  return lines;
 }
 
 void Pattern::print_pattern(const KnotColors &k, int sol_no, FILE *file) const
@@ -126,15 +139,7 @@ int Pattern::check_line(int line, const vector<int> &strings_in,
   // Knots either switch the input strings or leave them as they are.
   // Permute through all knot possibilities for this line. If output
   // strings are able to make the line below, recurse.
-  descent_cnt++;
-  if (descent_cnt % 100000 == 0) {
-    fprintf(stderr, ".");
-    if (descent_cnt % 1000000 == 0)
-      fprintf(stderr, " ");
-    if (descent_cnt % 7000000 == 0)
-      fprintf(stderr, "\n");
-    fflush(stderr);
-  }
+  count_descent();
 
   // knots is effectively a binary numbery
   if (try_optimal && prefer_pure)                    // try pure knots only
@@ -157,14 +162,8 @@ int Pattern::check_line(int line, const vector<int> &strings_in,
     // check each knot in the next line (wrap) is met by at least one
     // string of the same colour
     const int next_line = (line < (int)knots.size() - 1) ? line + 1 : 0;
-    int next_first = !first;
-    for (unsigned int i = 0; i < k.knots[next_line].size(); i++) {
-      if (k.knots[next_line][i] != strings_out[next_first + 2 * i] &&
-          k.knots[next_line][i] != strings_out[next_first + 2 * i + 1]) {
-        valid = false;
-        break;
-      }
-    }
+    if (!knots_met(k.knots[next_line], strings_out, !first))
+      valid = false;
 
     // Check whether strings match when wrapping to beginning
     if (valid && !next_line)
@@ -205,24 +204,35 @@ int Pattern::check_line(int line, const vector<int> &strings_in,
     if (only_symmetric) {
       int r_cnt = knots[line].size() - l_cnt;
       knots[line] = half;
-      knots[line].insert(knots[line].end(), half.rbegin(),
-                         half.rbegin() + r_cnt);
+      knots[line].insert(knots[line].end(), half.rbegin() + (l_cnt - r_cnt),
+                         half.rend());
     }
   }
 
   return valid; // none of the knot permutations for this line were valid
 }
 
-vector<Pattern> Pattern::solve(const KnotColors &k, bool optimal)
+void Pattern::solve(const KnotColors &k, SolutionStore &sols, bool optimal)
 {
   // initialise knots
   knots.clear();
   knots.resize(k.knots.size());
   for (unsigned int i = 0; i < k.knots.size(); i++)
     knots[i].resize(k.knots[i].size());
-  vector<Pattern> sols;
-  check_line(0, strings, k, sols, optimal);
-  return sols;
+  std::unique_ptr<LineSearch> search =
+      LineSearch::create(*this, k, sols, optimal);
+  if (cancel) {
+    // run in stretches, checking between them whether to stop
+    const long cancel_check_descents = 100000;
+    while (!search->run(cancel_check_descents)) {
+      if (*cancel) {
+        stopped = true;
+        break;
+      }
+    }
+  }
+  else
+    search->run();
 }
 
 string Pattern::get_strings_text(map<int, char> &idx2col)
@@ -241,10 +251,20 @@ string Pattern::get_strings_text(map<int, char> &idx2col)
 vector<int> get_next_strings(const vector<int> &strings_in,
                              const vector<int> &knots, int offset,
                              bool prefer_pure, int *line_score)
+{
+  vector<int> strings_out;
+  get_next_strings(strings_in, knots, offset, strings_out, prefer_pure,
+                   line_score);
+  return strings_out;
+}
+
+void get_next_strings(const vector<int> &strings_in, const vector<int> &knots,
+                      int offset, vector<int> &strings_out, bool prefer_pure,
+                      int *line_score)
 {
   if (line_score)
     *line_score = 0;
-  vector<int> strings_out = strings_in;
+  strings_out = strings_in;
   for (unsigned int i = 0; i < knots.size(); i++) {
     if (line_score)
       *line_score += knots[i] != prefer_pure;
@@ -266,8 +286,6 @@ vector<int> get_next_strings(const vector<int> &strings_in,
       }
     }
   }
-
-  return strings_out;
 }
 
 int increment(vector<int> &digits)
@@ -25,8 +25,12 @@
 #define PATTERN_H
 
 #include "knotcolors.h"
+#include <atomic>
 #include <vector>
 
+class SearchStats;
+class SolutionStore;
+
 class Pattern {
 public:
   int soln_no;      // for all solutions
@@ -38,6 +42,13 @@ public:
 
   bool prefer_pure;    // find solution with most pure/mixed knots
   bool only_symmetric; // only look for symmetric solutions
+  int max_solutions;   // stop adding solutions after this many (0: no limit)
+  bool prove_optimal;  // after max_solutions, search for better solutions
+  bool generic_search; // use GenericSearch, even if a faster search applies
+  bool stopped;        // the search was stopped early
+  const std::atomic<bool> *cancel; // stop the search when set (0: never)
+  const DescentFunction *descent_fn; // report descents (0: no report)
+  SearchStats *stats;                // collect statistics (0: none)
 
   std::vector<int> strings;            // start strings
   std::vector<std::vector<int>> knots; // knots (swap strings or not)
@@ -45,6 +56,7 @@ public:
   long descent_cnt; // number of recursion descents
 
   Pattern();
+  void count_descent();
   void set_score_limit(int lim) { score_limit = lim; }
   void set_strings(const std::vector<int> &strs) { strings = strs; }
   void set_prefer_pure(int pure) { prefer_pure = pure; }
@@ -65,15 +77,52 @@ public:
     soln_no++;
   }
 
+  // recursive search, equivalent to the search made by solve() with LineSearch
   int check_line(int line, const std::vector<int> &strs, const KnotColors &k,
                  std::vector<Pattern> &sols, bool try_optimal = false,
                  int cur_score = 0);
-  std::vector<Pattern> solve(const KnotColors &k, bool optimal = false);
+  void solve(const KnotColors &k, SolutionStore &sols, bool optimal = false);
   std::string get_strings_text(std::map<int, char> &idx2col);
 
   void print_pattern(const KnotColors &k, int sol_no, FILE *file) const;
   void print_strings_and_knots(const KnotColors &k, FILE *file) const;
   void print_generator_pattern(const KnotColors &k, FILE *file) const;
+  // knot types of each line, as in the generator pattern format
+  std::vector<std::string> get_generator_knots(const KnotColors &k) const;
 };
 
+/// Get the strings leaving a knot line
+/**\param strings_in the strings entering the line.
+ * \param knots the knots of the line (1 to swap strings, 0 to leave).
+ * \param offset the first string that will be knotted.
+ * \param strings_out used to return the strings leaving the line.
+ * \param prefer_pure whether pure knots are preferred.
+ * \param line_score if given, used to return the score for the line, or -1
+ *  if the knots make a redundant solution. */
+void get_next_strings(const std::vector<int> &strings_in,
+                      const std::vector<int> &knots, int offset,
+                      std::vector<int> &strings_out, bool prefer_pure = true,
+                      int *line_score = 0);
+std::vector<int> get_next_strings(const std::vector<int> &strings_in,
+                                  const std::vector<int> &knots, int offset,
+                                  bool prefer_pure = true,
+                                  int *line_score = 0);
+int increment(std::vector<int> &digits);
+
+/// Check whether each knot of a line is met by a string of its colour
+/**\param knot_cols the knot colours of the line.
+ * \param strings the strings entering the line.
+ * \param offset the first string that will be knotted.
+ * \return \c true if every knot is met by at least one of its two
+ *  strings, otherwise \c false. */
+inline bool knots_met(const std::vector<int> &knot_cols,
+                      const std::vector<int> &strings, int offset)
+{
+  for (unsigned int i = 0; i < knot_cols.size(); i++)
+    if (knot_cols[i] != strings[offset + 2 * i] &&
+        knot_cols[i] != strings[offset + 2 * i + 1])
+      return false;
+  return true;
+}
+
 #endif // PATTERN_H
@@ -0,0 +1,275 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file pattext.cc
+   \brief knotting patterns held as text, in the generator pattern format
+*/
+
+#include "pattext.h"
+#include "utils.h"
+#include <algorithm>
+#include <ctype.h>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+int read_pattern(FILE *ifile, string &strings, vector<string> &knot_lines,
+                 char *msg)
+{
+  *msg = '\0';
+  int file_line_no = 0; // line number in the file
+
+  strings = "";
+  char *line = 0;
+  while (read_line(ifile, &line) == 0) {
+    file_line_no++;
+    // fprintf(stderr, "line %d: '%s'\n", file_line_no, line);
+    string data;
+    for (char *p = line; *p; p++)
+      if (!isspace(*p))
+        data += *p;
+    free(line);
+
+    if (data == "")
+      continue;
+
+    if (strings == "") {
+      strings = data;
+      continue;
+    }
+
+    size_t c_idx;
+    if ((c_idx = strspn(data.c_str(), "DdRr")) != data.size()) {
+      snprintf(msg, MSG_SZ,
+               "line %d: knot line included invalid character '%c'",
+               file_line_no, data[c_idx]);
+      break;
+    }
+
+    unsigned int valid_len = strings.size() / 2;
+    if (strings.size() % 2 == 0)
+      valid_len -= knot_lines.size() % 2;
+    if (data.size() != valid_len) {
+      snprintf(msg, MSG_SZ, "line %d: knot line had %d knots, should have %d",
+               file_line_no, (int)data.size(), (int)valid_len);
+      break;
+    }
+
+    knot_lines.push_back(data);
+  }
+
+  if (!*msg) {
+    if (!strings.size())
+      sprintf(msg, "file contains no data");
+    else if (!knot_lines.size())
+      sprintf(msg, "file contains no knot lines");
+    else if (!knot_lines.size() % 2)
+      sprintf(msg, "file does not contains an even number of knot lines (did "
+                   "you include the strings as the first line?)");
+  }
+
+  return *msg == 0;
+}
+
+string get_next_strings(const string &strings_in, const string &knots,
+                        int offset)
+{
+  string strings_out = strings_in;
+  for (unsigned int i = 0; i < knots.size(); i++) {
+    if (knots[i] == 'D' || knots[i] == 'd') {
+      // fprintf(stderr, "swapping %d and %d\n", offset+2*i,offset+2*i+1);
+      std::swap(strings_out[offset + 2 * i], strings_out[offset + 2 * i + 1]);
+    }
+  }
+
+  return strings_out;
+}
+
+string get_knots(const string &strings_in, const string &knots, int offset)
+{
+  string knot_cols(knots.size(), ' ');
+  for (unsigned int i = 0; i < knots.size(); i++)
+    knot_cols[i] =
+        strings_in[offset + 2 * i + (knots[i] == 'R' || knots[i] == 'd')];
+
+  return knot_cols;
+}
+
+void print_strings(const string &strings, FILE *file)
+{
+  for (unsigned int i = 0; i < strings.size(); i++)
+    fprintf(file, "%c ", strings[i]);
+  fprintf(file, "\n");
+}
+
+void print_knots(const string &knot_cols, int offset, FILE *file)
+{
+  fprintf(file, "%s", offset ? " " : "");
+  for (unsigned int i = 0; i < knot_cols.size(); i++)
+    fprintf(file, "%c ", knot_cols[i]);
+  fprintf(file, "\n");
+}
+
+void print_result(const string &strings, const vector<string> &knot_lines,
+                  bool include_strs, FILE *file)
+{
+  if (include_strs)
+    print_strings(strings, file);
+
+  string next_strings = strings;
+  for (unsigned int i = 0; i < knot_lines.size(); i++) {
+    int offset = i % 2;
+    string knots = get_knots(next_strings, knot_lines[i], offset);
+    print_knots(knots, offset, file);
+    next_strings = get_next_strings(next_strings, knot_lines[i], offset);
+    if (include_strs)
+      print_strings(next_strings, file);
+  }
+}
+
+void print_pattern_text(const string &strings,
+                        const vector<string> &knot_lines, FILE *file)
+{
+  fprintf(file, "%s\n", strings.c_str());
+  for (const auto &line : knot_lines)
+    fprintf(file, "%s\n", line.c_str());
+}
+
+// The random choices only use the output of the generator, which is the
+// same everywhere, rather than the standard distributions, which are not,
+// so a seed makes the same design on every platform.
+
+// A random number from 0 to n-1
+static int rnd_below(int n, std::mt19937_64 &rng) { return rng() % n; }
+
+// True with probability prob
+static bool rnd_chance(double prob, std::mt19937_64 &rng)
+{
+  return (rng() >> 11) * (1.0 / (1ULL << 53)) < prob;
+}
+
+// Random string colours, using every colour
+static string random_strings(int width, int colours, std::mt19937_64 &rng)
+{
+  string strings(width, ' ');
+  for (int i = 0; i < width; i++)
+    strings[i] = 'a' + (i < colours ? i : rnd_below(colours, rng));
+  for (int i = width - 1; i > 0; i--)
+    std::swap(strings[i], strings[rnd_below(i + 1, rng)]);
+  return strings;
+}
+
+// A knot that swaps its strings, or not, tied forward or backward at random
+static char random_knot(bool swap, std::mt19937_64 &rng)
+{
+  const bool forward = rng() & 1;
+  if (swap)
+    return forward ? 'D' : 'd';
+  else
+    return forward ? 'r' : 'R';
+}
+
+// Make a pattern of knot lines with num_random lines of random knots,
+// followed by lines that sort the strings back to their starting colours.
+// The sorting lines are an odd-even transposition sort, which needs at
+// most one line for each string. Return whether the strings were sorted.
+static bool make_pattern(int width, int height, int colours, double swap_prob,
+                         const string &strings, int num_random,
+                         std::mt19937_64 &rng, vector<string> &knot_lines)
+{
+  knot_lines.assign(height, string());
+  string cur = strings;
+  for (int i = 0; i < num_random; i++) {
+    const int offset = i % 2;
+    for (int j = offset; j < width - 1; j += 2) {
+      const bool swap = rnd_chance(swap_prob, rng);
+      knot_lines[i] += random_knot(swap, rng);
+      if (swap)
+        std::swap(cur[j], cur[j + 1]);
+    }
+  }
+
+  // Give each string the position it must return to. Strings of the same
+  // colour keep their order, so they never need to cross.
+  vector<int> dest(width);
+  for (int col = 'a'; col < 'a' + colours; col++) {
+    int pos = 0;
+    for (int i = 0; i < width; i++) {
+      if (cur[i] == col) {
+        while (strings[pos] != col)
+          pos++;
+        dest[i] = pos++;
+      }
+    }
+  }
+
+  for (int i = num_random; i < height; i++) {
+    const int offset = i % 2;
+    for (int j = offset; j < width - 1; j += 2) {
+      const bool swap = dest[j] > dest[j + 1];
+      knot_lines[i] += random_knot(swap, rng);
+      if (swap)
+        std::swap(dest[j], dest[j + 1]);
+    }
+  }
+
+  return std::is_sorted(dest.begin(), dest.end());
+}
+
+void random_pattern(int width, int height, int colours, double swap_prob,
+                    int seed, string &strings, vector<string> &knot_lines)
+{
+  std::mt19937_64 rng(seed);
+  strings = random_strings(width, colours, rng);
+
+  // Use at least half of the lines for random knots. If the remaining lines
+  // are too few to sort every arrangement then try again with new random
+  // knots, and eventually with fewer random lines.
+  const int tries_per_size = 100;
+  int num_random = std::max(height - width, height / 2);
+  for (int tries = 1;; tries++) {
+    if (make_pattern(width, height, colours, swap_prob, strings, num_random,
+                     rng, knot_lines))
+      break;
+    if (tries % tries_per_size == 0)
+      num_random--;
+  }
+}
+
+vector<string> get_design(const string &strings,
+                          const vector<string> &knot_lines)
+{
+  vector<string> design;
+  string next_strings = strings;
+  for (unsigned int i = 0; i < knot_lines.size(); i++) {
+    int offset = i % 2;
+    design.push_back(get_knots(next_strings, knot_lines[i], offset));
+    next_strings = get_next_strings(next_strings, knot_lines[i], offset);
+  }
+  return design;
+}
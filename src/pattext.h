@@ -0,0 +1,114 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file pattext.h
+   \brief knotting patterns held as text, in the generator pattern format
+*/
+
+#ifndef PATTEXT_H
+#define PATTEXT_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/// Read a pattern in the generator pattern format
+/** The first line holds a character for the colour of each string, the
+ *  following lines hold a knotting pattern, with a character from "DdRr"
+ *  for each knot.
+ * \param ifile the file to read from.
+ * \param strings used to return the string colours.
+ * \param knot_lines used to return the knot lines.
+ * \param msg used to return an error message, of size \c MSG_SZ.
+ * \return \c true if the pattern was read, otherwise \c false. */
+int read_pattern(FILE *ifile, std::string &strings,
+                 std::vector<std::string> &knot_lines, char *msg);
+
+/// Get the strings that leave a line of knots
+/**\param strings_in the strings entering the line.
+ * \param knots the knots of the line, as "DdRr" characters.
+ * \param offset the position of the first string knotted in the line.
+ * \return the strings leaving the line. */
+std::string get_next_strings(const std::string &strings_in,
+                             const std::string &knots, int offset);
+
+/// Get the colours of a line of knots
+/**\param strings_in the strings entering the line.
+ * \param knots the knots of the line, as "DdRr" characters.
+ * \param offset the position of the first string knotted in the line.
+ * \return the colour of each knot. */
+std::string get_knots(const std::string &strings_in, const std::string &knots,
+                      int offset);
+
+/// Print string colours, separated by spaces
+/**\param strings the string colours.
+ * \param file the file to print to. */
+void print_strings(const std::string &strings, FILE *file = stdout);
+
+/// Print a line of knot colours, in the design format
+/**\param knot_cols the knot colours.
+ * \param offset the position of the first string knotted in the line.
+ * \param file the file to print to. */
+void print_knots(const std::string &knot_cols, int offset,
+                 FILE *file = stdout);
+
+/// Print the design made by a knotting pattern
+/**\param strings the string colours.
+ * \param knot_lines the knot lines, as "DdRr" characters.
+ * \param include_strs also print the strings between the knot lines.
+ * \param file the file to print to. */
+void print_result(const std::string &strings,
+                  const std::vector<std::string> &knot_lines,
+                  bool include_strs = false, FILE *file = stdout);
+
+/// Print a knotting pattern in the generator pattern format
+/**\param strings the string colours.
+ * \param knot_lines the knot lines, as "DdRr" characters.
+ * \param file the file to print to. */
+void print_pattern_text(const std::string &strings,
+                        const std::vector<std::string> &knot_lines,
+                        FILE *file = stdout);
+
+/// Make a random knotting pattern whose strings return to their start
+/** The first lines have random knots, and the remaining lines sort the
+ *  strings back to their starting colours. A seed makes the same pattern
+ *  on every platform.
+ * \param width the number of strings, 3 or more.
+ * \param height the number of knot lines, even and 2 or more.
+ * \param colours the number of colours, from 1 to 26, and no more than
+ *  \a width. The colours are the letters from 'a'.
+ * \param swap_prob the probability that a random knot swaps its strings.
+ * \param seed the seed for the random choices.
+ * \param strings used to return the string colours.
+ * \param knot_lines used to return the knot lines, as "DdRr" characters. */
+void random_pattern(int width, int height, int colours, double swap_prob,
+                    int seed, std::string &strings,
+                    std::vector<std::string> &knot_lines);
+
+/// Get the design made by a knotting pattern
+/**\param strings the string colours.
+ * \param knot_lines the knot lines, as "DdRr" characters.
+ * \return the knot colours of each line. */
+std::vector<std::string> get_design(const std::string &strings,
+                                    const std::vector<std::string> &knot_lines);
+
+#endif // PATTEXT_H
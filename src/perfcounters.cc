@@ -0,0 +1,256 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file perfcounters.cc
+   \brief hardware performance counters of the search
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "../config.h"
+#endif
+
+#include "perfcounters.h"
+#include "utils.h"
+#include <algorithm>
+#include <string.h>
+
+#ifdef HAVE_LINUX_PERF_EVENT_H
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using std::string;
+
+PerfCounters::PerfCounters()
+{
+  for (int &fd : fds)
+    fd = -1;
+}
+
+PerfCounters::~PerfCounters() { close(); }
+
+#ifdef HAVE_LINUX_PERF_EVENT_H
+static string perf_error_msg(int err)
+{
+  if (err == EACCES || err == EPERM)
+    return "the kernel does not allow performance counters (they may be "
+           "blocked in a container, or by kernel.perf_event_paranoid)";
+  if (err == ENOENT || err == ENODEV || err == EOPNOTSUPP)
+    return "the processor, or virtual machine, has no hardware "
+           "performance counters";
+  if (err == ENOSYS)
+    return "the kernel does not support performance counters";
+  return msg_str("performance counters not available: %s", strerror(err));
+}
+#endif
+
+Status PerfCounters::open()
+{
+  close();
+#ifdef HAVE_LINUX_PERF_EVENT_H
+  const uint64_t configs[num_counters] = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES};
+  int first_err = 0;
+  int num_open = 0;
+  for (int i = 0; i < num_counters; i++) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = configs[i];
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format =
+        PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // this thread, on any processor
+    fds[i] = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fds[i] >= 0)
+      num_open++;
+    else if (!first_err)
+      first_err = errno;
+  }
+
+  if (num_open == 0)
+    return Status::error(perf_error_msg(first_err));
+  if (num_open < num_counters) {
+    string missing;
+    for (int i = 0; i < num_counters; i++)
+      if (fds[i] < 0)
+        missing += string(missing.empty() ? "" : ", ") + name(i);
+    return Status::warning(
+        msg_str("some performance counters are not available: %s",
+                missing.c_str()));
+  }
+  return Status::ok();
+#else
+  return Status::error(
+      "hardware performance counters are only available on Linux");
+#endif
+}
+
+void PerfCounters::close()
+{
+  for (int &fd : fds) {
+#ifdef HAVE_LINUX_PERF_EVENT_H
+    if (fd >= 0)
+      ::close(fd);
+#endif
+    fd = -1;
+  }
+}
+
+void PerfCounters::read(int64_t vals[num_counters]) const
+{
+  for (int i = 0; i < num_counters; i++) {
+    vals[i] = -1;
+#ifdef HAVE_LINUX_PERF_EVENT_H
+    uint64_t buf[3]; // value, time enabled, time running
+    if (fds[i] >= 0 && ::read(fds[i], buf, sizeof(buf)) == sizeof(buf)) {
+      if (buf[2] == 0)
+        vals[i] = 0;
+      else if (buf[2] < buf[1])
+        vals[i] = (int64_t)((double)buf[0] * buf[1] / buf[2]);
+      else
+        vals[i] = buf[0];
+    }
+#endif
+  }
+}
+
+const char *PerfCounters::name(int counter)
+{
+  const char *names[num_counters] = {"cycles", "instructions",
+                                     "branch misses", "cache misses"};
+  return (counter >= 0 && counter < num_counters) ? names[counter] : "";
+}
+
+PerfProfile::PerfProfile()
+    : start_descents(0), block_descents(0), total_descents(0),
+      started(false), in_block(false)
+{
+}
+
+Status PerfProfile::start()
+{
+  blocks.clear();
+  in_block = false;
+  Status stat = counters.open();
+  started = !stat.is_error();
+  if (started)
+    counters.read(start_counts);
+  start_descents = 0;
+  return stat;
+}
+
+void PerfProfile::end_block(long descents, const int64_t *counts)
+{
+  Block block;
+  block.label = block_label;
+  block.descents = descents - block_descents;
+  for (int i = 0; i < PerfCounters::num_counters; i++)
+    block.counts[i] = (counts[i] < 0) ? -1 : counts[i] - block_counts[i];
+  blocks.push_back(block);
+  in_block = false;
+}
+
+void PerfProfile::start_block(const string &label, long descents)
+{
+  if (!started)
+    return;
+  int64_t counts[PerfCounters::num_counters];
+  counters.read(counts);
+  if (in_block)
+    end_block(descents, counts);
+  block_label = label;
+  block_descents = descents;
+  std::copy(counts, counts + PerfCounters::num_counters, block_counts);
+  in_block = true;
+}
+
+void PerfProfile::stop(long descents)
+{
+  if (!started)
+    return;
+  int64_t counts[PerfCounters::num_counters];
+  counters.read(counts);
+  counters.close();
+  if (in_block)
+    end_block(descents, counts);
+  total_descents = descents - start_descents;
+  for (int i = 0; i < PerfCounters::num_counters; i++)
+    total_counts[i] = (counts[i] < 0) ? -1 : counts[i] - start_counts[i];
+  started = false;
+}
+
+void PerfProfile::print_row(FILE *ofile, const char *title, long descents,
+                            const int64_t *counts) const
+{
+  fprintf(ofile, "  %5s  %12ld", title, descents);
+  const double desc = descents > 0 ? descents : 1;
+  const int64_t cyc = counts[PerfCounters::cycles];
+  const int64_t ins = counts[PerfCounters::instructions];
+  if (cyc >= 0)
+    fprintf(ofile, "  %10.1f", cyc / desc);
+  else
+    fprintf(ofile, "  %10s", "-");
+  if (cyc > 0 && ins >= 0)
+    fprintf(ofile, "  %6.2f", (double)ins / cyc);
+  else
+    fprintf(ofile, "  %6s", "-");
+  const int64_t br = counts[PerfCounters::branch_misses];
+  if (br >= 0)
+    fprintf(ofile, "  %11.3f", br / desc);
+  else
+    fprintf(ofile, "  %11s", "-");
+  const int64_t cache = counts[PerfCounters::cache_misses];
+  if (cache >= 0)
+    fprintf(ofile, "  %10.3f", cache / desc);
+  else
+    fprintf(ofile, "  %10s", "-");
+}
+
+void PerfProfile::print(FILE *ofile) const
+{
+  fprintf(ofile, "\nHardware performance counters, per descent\n\n"
+                 "  block      descents      cycles     IPC  "
+                 "branch-miss  cache-miss  free strings\n");
+  for (size_t i = 0; i < blocks.size(); i++) {
+    const Block &block = blocks[i];
+    print_row(ofile, msg_str("%d", (int)i + 1).c_str(), block.descents,
+              block.counts);
+    fprintf(ofile, "  %s\n", block.label.c_str());
+  }
+  print_row(ofile, "total", total_descents, total_counts);
+  fprintf(ofile, "\n\n");
+
+  for (int i = 0; i < PerfCounters::num_counters; i++) {
+    fprintf(ofile, "%s: ", PerfCounters::name(i));
+    if (total_counts[i] >= 0)
+      fprintf(ofile, "%lld\n", (long long)total_counts[i]);
+    else
+      fprintf(ofile, "not available\n");
+  }
+  fprintf(ofile, "descents: %ld\n", total_descents);
+}
@@ -0,0 +1,134 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file perfcounters.h
+   \brief hardware performance counters of the search
+*/
+
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include "status.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/// Hardware performance counters of the calling thread
+/** The counters are opened with the Linux perf_event_open system call,
+ *  counting in user space only. The kernel may not allow this, e.g. in
+ *  containers, or when kernel.perf_event_paranoid is set above 2, and
+ *  some counters may not be supported by the processor or a virtual
+ *  machine. Counters that can't be opened read as -1. */
+class PerfCounters {
+public:
+  /// The counters
+  enum {
+    cycles,        ///< processor cycles
+    instructions,  ///< instructions retired
+    branch_misses, ///< mispredicted branches
+    cache_misses,  ///< last level cache misses
+    num_counters   ///< number of counters
+  };
+
+private:
+  int fds[num_counters];
+
+public:
+  /// Constructor
+  PerfCounters();
+
+  /// Destructor, closes the counters
+  ~PerfCounters();
+
+  /// Open the counters and start counting
+  /**\return status, an error if no counter could be opened, a warning
+   *  if only some could be opened. */
+  Status open();
+
+  /// Close the counters
+  void close();
+
+  /// Read the counters
+  /** A counter that the kernel shared with other events is scaled up
+   *  to the whole time it was enabled.
+   * \param vals used to return the count of each counter, or -1 if it
+   *  isn't open. */
+  void read(int64_t vals[num_counters]) const;
+
+  /// Get the name of a counter
+  /**\param counter the counter.
+   * \return the name. */
+  static const char *name(int counter);
+};
+
+/// Hardware performance counters of a search, and of each block of it
+/** The search is divided into blocks, one for each set of free string
+ *  colours, and the counters and descents are recorded for each block,
+ *  to be shown per descent. */
+class PerfProfile {
+private:
+  struct Block {
+    std::string label;
+    long descents;
+    int64_t counts[PerfCounters::num_counters];
+  };
+
+  PerfCounters counters;
+  std::vector<Block> blocks;
+  int64_t start_counts[PerfCounters::num_counters];
+  int64_t block_counts[PerfCounters::num_counters];
+  int64_t total_counts[PerfCounters::num_counters];
+  long start_descents;
+  long block_descents;
+  long total_descents;
+  std::string block_label;
+  bool started;
+  bool in_block;
+
+  void end_block(long descents, const int64_t *counts);
+  void print_row(FILE *ofile, const char *title, long descents,
+                 const int64_t *counts) const;
+
+public:
+  /// Constructor
+  PerfProfile();
+
+  /// Open the counters and start counting
+  /**\return status, as from PerfCounters::open(). */
+  Status start();
+
+  /// Start a block, ending any current block
+  /**\param label a description of the block.
+   * \param descents the descents of the search so far. */
+  void start_block(const std::string &label, long descents);
+
+  /// Stop counting, ending any current block
+  /**\param descents the descents of the whole search. */
+  void stop(long descents);
+
+  /// Print the counters, per descent, for each block and the search
+  /**\param ofile the file to print to. */
+  void print(FILE *ofile) const;
+};
+
+#endif // PERFCOUNTERS_H
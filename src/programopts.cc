@@ -119,10 +119,13 @@ bool ProgramOpts::common_opts(char c, char opt)
   return true;
 }
 
-void ProgramOpts::handle_long_opts(int argc, char *argv[])
+void ProgramOpts::handle_long_opts(int argc, char *argv[],
+                                   const struct option *long_opts)
 {
   for (int i = 1; i < argc; i++) {
-    if (strcmp(argv[i], "--help") == 0) {
+    if (strcmp(argv[i], "--") == 0) // end of options
+      break;
+    else if (strcmp(argv[i], "--help") == 0) {
       usage();
       exit(0);
     }
@@ -130,8 +133,23 @@ void ProgramOpts::handle_long_opts(int argc, char *argv[])
       version();
       exit(0);
     }
-    else if (strncmp(argv[i], "--", 2) == 0 && strlen(argv[i]) > 2)
-      error("unknown option", argv[i]);
+    else if (strncmp(argv[i], "--", 2) == 0 && strlen(argv[i]) > 2) {
+      const char *name = argv[i] + 2;
+      const size_t len = strcspn(name, "=");
+      bool known = false;
+      for (const struct option *opt = long_opts; opt && opt->name; opt++)
+        if (strlen(opt->name) == len && strncmp(opt->name, name, len) == 0) {
+          known = true;
+          if (opt->has_arg == required_argument && name[len] == '\0') {
+            if (i + 1 >= argc)
+              error("missing argument", argv[i]);
+            i++; // skip separate argument
+          }
+          break;
+        }
+      if (!known)
+        error("unknown option", argv[i]);
+    }
   }
 }
 
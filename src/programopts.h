@@ -126,9 +126,14 @@ public:
   void print_status_or_exit(const Status &stat, char opt) const;
 
   /// Process long options
-  /**\param argc the number of arguments.
-   * \param argv pointers to the argument strings. */
-  void handle_long_opts(int argc, char *argv[]);
+  /** Handles \c --help and \c --version, and exits with an error for
+   *  any other long option that is not in \a long_opts.
+   * \param argc the number of arguments.
+   * \param argv pointers to the argument strings.
+   * \param long_opts long options that the program will process with
+   *  \c getopt_long, terminated by an option with a null name. */
+  void handle_long_opts(int argc, char *argv[],
+                        const struct option *long_opts = nullptr);
 
   /// Process common options
   /**\param c the character returned by getopt.
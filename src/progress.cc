@@ -0,0 +1,135 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "progress.h"
+#include "pattern.h"
+#include "utils.h"
+#include <limits.h>
+
+using std::string;
+
+ProgressReporter::ProgressReporter(double secs, FILE *out, bool as_json)
+    : perms(0), strs_no(0), perm_no(0), descents(0), best_score(INT_MAX),
+      kc(nullptr), ofile(out), json(as_json), interval(secs), stopping(false)
+{
+}
+
+ProgressReporter::~ProgressReporter() { stop(); }
+
+void ProgressReporter::set_callbacks(SolveOpts &opts, const KnotColors &k)
+{
+  kc = &k;
+  opts.progress = [this](const SolveProgress &prog) {
+    if (prog.perm_no == 0) { // the counts only change with the first
+      std::lock_guard<std::mutex> lock(cnts_mtx);
+      free_cnts = prog.free_strings;
+    }
+    strs_no.store(prog.strs_no, std::memory_order_relaxed);
+    perm_no.store(prog.perm_no, std::memory_order_relaxed);
+    perms.fetch_add(1, std::memory_order_relaxed);
+  };
+  opts.descents = [this](long descent_cnt) {
+    descents.store(descent_cnt, std::memory_order_relaxed);
+  };
+  opts.solution = [this](const Pattern &pat) {
+    best_score.store(pat.score, std::memory_order_relaxed);
+  };
+}
+
+void ProgressReporter::start()
+{
+  start_time = std::chrono::steady_clock::now();
+  stopping = false;
+  reporter = std::thread(&ProgressReporter::run, this);
+}
+
+void ProgressReporter::stop(long total_descents)
+{
+  if (!reporter.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    stopping = true;
+  }
+  stop_cv.notify_all();
+  reporter.join();
+  if (total_descents >= 0)
+    descents.store(total_descents, std::memory_order_relaxed);
+  if (json)
+    report("done");
+}
+
+void ProgressReporter::run()
+{
+  const auto period = std::chrono::duration_cast<
+      std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(interval));
+  auto next = start_time + period;
+  std::unique_lock<std::mutex> lock(mtx);
+  while (!stop_cv.wait_until(lock, next, [this] { return stopping; })) {
+    report();
+    next += period;
+  }
+}
+
+string ProgressReporter::counts_json()
+{
+  std::lock_guard<std::mutex> lock(cnts_mtx);
+  string cnts;
+  for (size_t i = 0; i < free_cnts.size(); i++)
+    cnts += msg_str("%s\"%c\":%d", i ? "," : "", kc->get_colour(i),
+                    free_cnts[i]);
+  return "{" + cnts + "}";
+}
+
+void ProgressReporter::report(const char *event)
+{
+  const double secs = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - start_time)
+                          .count();
+  const int score = best_score.load(std::memory_order_relaxed);
+  if (json) {
+    fprintf(ofile,
+            "{\"event\":\"%s\",\"seconds\":%.3f,\"strs_no\":%d,"
+            "\"perm_no\":%d,\"free_counts\":%s,\"permutations\":%ld,"
+            "\"descents\":%ld,\"best_score\":%s}\n",
+            event, secs, strs_no.load(std::memory_order_relaxed),
+            perm_no.load(std::memory_order_relaxed), counts_json().c_str(),
+            perms.load(std::memory_order_relaxed),
+            descents.load(std::memory_order_relaxed),
+            score != INT_MAX ? msg_str("%d", score).c_str() : "null");
+    fflush(ofile);
+    return;
+  }
+
+  fprintf(ofile, "[%8.1fs] colour counts %d, permutation %d, %ld tried, "
+                 "%ld descents",
+          secs, strs_no.load(std::memory_order_relaxed),
+          perm_no.load(std::memory_order_relaxed),
+          perms.load(std::memory_order_relaxed),
+          descents.load(std::memory_order_relaxed));
+  if (score != INT_MAX)
+    fprintf(ofile, ", best score %d", score);
+  fprintf(ofile, "\n");
+  fflush(ofile);
+}
@@ -0,0 +1,104 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file progress.h
+   \brief periodic report of the progress of a search
+*/
+
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include "knotcolors.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Report the progress of a search at a fixed interval
+/** The search callbacks only update atomic counters. A reporter thread
+ *  wakes at each interval and prints a single line with the counters,
+ *  so the cost to the search does not depend on how fast it runs, and
+ *  a long search writes a steady, small amount of output. Nothing is
+ *  printed by a search that finishes within the first interval.
+ *
+ *  The lines may be text, or JSON objects (NDJSON) with an \c event of
+ *  \c progress. In JSON a final \c done event is printed when the
+ *  reporter is stopped. */
+class ProgressReporter {
+private:
+  std::atomic<long> perms;    // start string permutations tried
+  std::atomic<int> strs_no;   // current free string colour counts
+  std::atomic<int> perm_no;   // current permutation of the start strings
+  std::atomic<long> descents; // descents of the current search
+  std::atomic<int> best_score;
+  std::mutex cnts_mtx;
+  std::vector<int> free_cnts; // current free string colour counts
+  const KnotColors *kc;
+  FILE *ofile;
+  bool json;
+  double interval;
+  std::chrono::steady_clock::time_point start_time;
+  bool stopping;
+  std::mutex mtx;
+  std::condition_variable stop_cv;
+  std::thread reporter;
+
+  void run();
+  void report(const char *event = "progress");
+  std::string counts_json();
+
+public:
+  /// Constructor
+  /**\param secs the number of seconds between reports.
+   * \param out the file to print the reports to.
+   * \param as_json print the reports as JSON objects. */
+  explicit ProgressReporter(double secs, FILE *out = stderr,
+                            bool as_json = false);
+
+  /// Destructor, stops the reporter thread
+  ~ProgressReporter();
+
+  ProgressReporter(const ProgressReporter &) = delete;
+  ProgressReporter &operator=(const ProgressReporter &) = delete;
+
+  /// Set search callbacks to update the counters
+  /**\param opts the search options to set the \c progress, \c descents
+   *  and \c solution callbacks of.
+   * \param k the design being searched. */
+  void set_callbacks(SolveOpts &opts, const KnotColors &k);
+
+  /// Start the reporter thread
+  void start();
+
+  /// Stop the reporter thread
+  /** There is no further report, except the \c done event in JSON.
+   * \param total_descents the descents of the whole search, for the
+   *  \c done event, or -1 to keep the count last reported by the search,
+   *  which is only updated every 100000 descents. */
+  void stop(long total_descents = -1);
+};
+
+#endif // PROGRESS_H
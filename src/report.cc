@@ -0,0 +1,132 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file report.cc
+   \brief fast rendering of the solutions in a report
+*/
+
+#include "report.h"
+#include "knotcolors.h"
+#include "solutions.h"
+
+using std::string;
+using std::vector;
+
+ReportRenderer::ReportRenderer(const KnotColors &k, FILE *file)
+    : kc(k), ofile(file), colours(k.num_colours), knot_rows(k.knots.size()),
+      line_start(k.knots.size() + 1), strs(k.num_strings)
+{
+  for (int i = 0; i < k.num_colours; i++)
+    colours[i] = k.get_colour(i);
+
+  line_start[0] = 0;
+  for (unsigned int i = 0; i < k.knots.size(); i++) {
+    string &row = knot_rows[i];
+    char num[16];
+    snprintf(num, sizeof(num), "%3d:  ", i + 1);
+    row = string(num) + (i % 2 ? "   " : " ");
+    for (int knot : k.knots[i]) {
+      row += colours[knot];
+      row += "   ";
+    }
+    row += '\n';
+    line_start[i + 1] = line_start[i] + (k.knots[i].size() + 63) / 64;
+  }
+}
+
+ReportRenderer::~ReportRenderer() { flush(); }
+
+void ReportRenderer::render_strings(string &out, const char *indent)
+{
+  out += indent;
+  for (int str : strs) {
+    out += colours[str];
+    out += ' ';
+  }
+  out += '\n';
+}
+
+void ReportRenderer::render(const SolutionStore &solns, size_t idx,
+                            int sol_no)
+{
+  const SolutionStore::Ref &ref = solns.get_ref(idx);
+  char header[128];
+  snprintf(header, sizeof(header),
+           "\n-------------------------------------------\n"
+           "SOLUTION %5d (score: %4d)  (ref: %d/%d/%d)\n",
+           sol_no, ref.score, ref.strs_no, ref.perm_no, ref.var_no);
+  buf += header;
+  buf += "Text pattern format:\n\n";
+
+  // The text and generator formats are made in one pass down the lines
+  const bool prefer_pure = solns.get_prefer_pure();
+  const unsigned char *start = solns.get_strings(idx);
+  const uint64_t *knots = solns.get_knots(idx);
+  strs.assign(start, start + kc.num_strings);
+  gen_buf.clear();
+  render_strings(gen_buf, "");
+  gen_buf += '\n';
+  for (unsigned int i = 0; i < kc.knots.size(); i++) {
+    render_strings(buf, "      ");
+    buf += knot_rows[i];
+    const vector<int> &knot_cols = kc.knots[i];
+    const int nk = knot_cols.size();
+    const int offset = i % 2;
+    const uint64_t *words = knots + line_start[i];
+    for (int j = 0; j < nk; j++) {
+      const int w = j / 64;
+      const int bits = (nk - 64 * w < 64) ? nk - 64 * w : 64;
+      const bool swap = (words[w] >> (bits - 1 - j % 64)) & 1;
+      int &left = strs[offset + 2 * j];
+      int &right = strs[offset + 2 * j + 1];
+      // as in Pattern::get_generator_knots()
+      const bool switch_strs = (left == right) ? prefer_pure : swap;
+      const bool knot_left_str = (left == knot_cols[j]);
+      gen_buf += "RrdD"[2 * switch_strs + knot_left_str];
+      if (swap)
+        std::swap(left, right);
+    }
+    gen_buf += '\n';
+  }
+  strs.assign(start, start + kc.num_strings);
+  render_strings(buf, "      ");
+
+  buf += "\nGenerator pattern format:\n\n";
+  buf += gen_buf;
+  buf += "\n\n";
+  if (buf.size() >= 1 << 16)
+    flush();
+}
+
+void ReportRenderer::render_all(const SolutionStore &solns)
+{
+  for (size_t i = 0; i < solns.size(); i++)
+    render(solns, i, i);
+  flush();
+}
+
+void ReportRenderer::flush()
+{
+  if (buf.size())
+    fwrite(buf.data(), 1, buf.size(), ofile);
+  buf.clear();
+}
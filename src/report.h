@@ -0,0 +1,80 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file report.h
+   \brief fast rendering of the solutions in a report
+*/
+
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+class KnotColors;
+class SolutionStore;
+
+/// Render solutions in the text and generator pattern formats
+/** The output is the same as Pattern::print_pattern(), but is made
+ *  directly from the packed knots of a SolutionStore, with the colour
+ *  characters in an array and the knot colour lines, which are the same
+ *  for every solution, made once. The text is collected in a buffer and
+ *  written out in large blocks. */
+class ReportRenderer {
+private:
+  const KnotColors &kc;
+  FILE *ofile;
+  std::vector<char> colours;          // colour character of each index
+  std::vector<std::string> knot_rows; // knot colour line of the text format
+  std::vector<int> line_start;        // index of first word of each line
+  std::vector<int> strs;              // strings entering the current line
+  std::string buf;                    // text waiting to be written
+  std::string gen_buf;                // generator format of a solution
+
+  void render_strings(std::string &out, const char *indent);
+
+public:
+  /// Constructor
+  /**\param k the design.
+   * \param file the file to write to. */
+  ReportRenderer(const KnotColors &k, FILE *file);
+
+  /// Destructor, writes out any buffered text
+  ~ReportRenderer();
+
+  /// Render a solution
+  /**\param solns the solutions.
+   * \param idx the index of the solution to render.
+   * \param sol_no the number to give the solution in the report. */
+  void render(const SolutionStore &solns, size_t idx, int sol_no);
+
+  /// Render all the solutions of a store, numbered from 0
+  /**\param solns the solutions. */
+  void render_all(const SolutionStore &solns);
+
+  /// Write out the buffered text
+  void flush();
+};
+
+#endif // REPORT_H
@@ -0,0 +1,378 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "resultcache.h"
+#include "knotcolors.h"
+#include "pattern.h"
+#include "utils.h"
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+
+using std::string;
+using std::vector;
+
+static const char cache_header[] = "bracelet_solver results 1";
+
+// characters for the colours of a canonical design
+static const char canonical_cols[] =
+    "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+static const int max_colours = sizeof(canonical_cols) - 1;
+
+static vector<string> get_lines(const KnotColors &k)
+{
+  vector<string> lines(k.knots.size());
+  for (unsigned int i = 0; i < k.knots.size(); i++)
+    for (int col : k.knots[i])
+      lines[i] += k.get_colour(col);
+  return lines;
+}
+
+static int get_num_strings(const vector<string> &lines)
+{
+  return 1 + lines[0].size() + lines[1].size();
+}
+
+// A transformed design has line i made from line (i + rotate) of the
+// original, reversed if mirrored. The inverse has the same mirror, and
+// rotates the other way.
+static bool valid_transform(const vector<string> &lines, int rotate,
+                            bool mirror)
+{
+  return rotate % 2 == (mirror ? get_num_strings(lines) % 2 : 0);
+}
+
+static vector<string> transform_lines(const vector<string> &lines, int rotate,
+                                      bool mirror)
+{
+  const int num_lines = lines.size();
+  vector<string> trans(num_lines);
+  for (int i = 0; i < num_lines; i++) {
+    trans[i] = lines[(i + rotate) % num_lines];
+    if (mirror)
+      std::reverse(trans[i].begin(), trans[i].end());
+  }
+  return trans;
+}
+
+static ResultCache::Solution
+transform_solution(const ResultCache::Solution &soln, int rotate, bool mirror)
+{
+  const int num_lines = soln.knots.size();
+  ResultCache::Solution trans = soln;
+  string strs = soln.strings;
+  for (int i = 0; i < rotate; i++) {
+    for (unsigned int j = 0; j < soln.knots[i].size(); j++)
+      if (soln.knots[i][j] == '1')
+        std::swap(strs[i % 2 + 2 * j], strs[i % 2 + 2 * j + 1]);
+  }
+  trans.strings = strs;
+  if (mirror)
+    std::reverse(trans.strings.begin(), trans.strings.end());
+  for (int i = 0; i < num_lines; i++) {
+    trans.knots[i] = soln.knots[(i + rotate) % num_lines];
+    if (mirror)
+      std::reverse(trans.knots[i].begin(), trans.knots[i].end());
+  }
+  return trans;
+}
+
+string canonical_design(const vector<string> &lines, int *rotate, bool *mirror,
+                        string *colours)
+{
+  string best;
+  const int num_lines = lines.size();
+  for (int mir = 0; mir < 2; mir++)
+    for (int rot = 0; rot < num_lines; rot++) {
+      if (!valid_transform(lines, rot, mir))
+        continue;
+      string cols;
+      string form;
+      for (const auto &line : transform_lines(lines, rot, mir)) {
+        for (char c : line) {
+          size_t idx = cols.find(c);
+          if (idx == string::npos) {
+            idx = cols.size();
+            cols += c;
+          }
+          form += ((int)idx < max_colours) ? canonical_cols[idx] : '?';
+        }
+        form += '\n';
+      }
+      if (best.empty() || form < best) {
+        best = form;
+        *rotate = rot;
+        *mirror = mir;
+        *colours = cols;
+      }
+    }
+  return best;
+}
+
+string ResultCache::entry_key(const vector<string> &lines, bool prefer_pure,
+                              bool only_symmetric)
+{
+  int rotate;
+  bool mirror;
+  string colours;
+  return msg_str("%d %d\n", prefer_pure, only_symmetric) +
+         canonical_design(lines, &rotate, &mirror, &colours);
+}
+
+// knots are written as hexadecimal digits, four knots to a digit
+static string knots_to_hex(const vector<string> &knots)
+{
+  string bits;
+  for (const auto &line : knots)
+    bits += line;
+  while (bits.size() % 4)
+    bits += '0';
+  string hex;
+  for (unsigned int i = 0; i < bits.size(); i += 4) {
+    int val = 0;
+    for (int j = 0; j < 4; j++)
+      val = 2 * val + (bits[i + j] == '1');
+    hex += "0123456789abcdef"[val];
+  }
+  return hex;
+}
+
+static bool hex_to_knots(const char *hex, const vector<string> &lines,
+                         vector<string> &knots)
+{
+  string bits;
+  for (const char *p = hex; *p; p++) {
+    const char *digits = "0123456789abcdef";
+    const char *d = strchr(digits, *p);
+    if (!d)
+      return false;
+    for (int j = 3; j >= 0; j--)
+      bits += (((d - digits) >> j) & 1) ? '1' : '0';
+  }
+
+  knots.resize(lines.size());
+  size_t pos = 0;
+  for (unsigned int i = 0; i < lines.size(); i++) {
+    if (pos + lines[i].size() > bits.size())
+      return false;
+    knots[i] = bits.substr(pos, lines[i].size());
+    pos += lines[i].size();
+  }
+  return bits.size() - pos < 4;
+}
+
+Status ResultCache::read(FILE *ifile)
+{
+  Status stat;
+  char *line = nullptr;
+  vector<char *> parts;
+  int line_no = 0;
+  Entry entry;
+  int num_lines = 0;
+  int num_solns = 0;
+  while (read_line(ifile, &line) == 0) {
+    line_no++;
+    if (line_no == 1) {
+      if (strcmp(line, cache_header))
+        stat.set_error("not a results file, or unknown version");
+      free(line);
+      if (!stat)
+        break;
+      continue;
+    }
+
+    const int num_parts = split_line(line, parts);
+    if ((int)entry.lines.size() < num_lines) {
+      if (num_parts == 1)
+        entry.lines.push_back(parts[0]);
+      else
+        stat.set_error(msg_str("line %d: invalid design line", line_no));
+    }
+    else if ((int)entry.solns.size() < num_solns) {
+      Solution soln;
+      if (num_parts == 6) {
+        soln.strings = parts[0];
+        const char *refs[] = {parts[1], parts[2], parts[3], parts[4]};
+        int *vals[] = {&soln.ref.score, &soln.ref.strs_no, &soln.ref.perm_no,
+                       &soln.ref.var_no};
+        for (int i = 0; i < 4 && stat; i++)
+          stat = read_int(refs[i], vals[i]);
+        if (stat && !hex_to_knots(parts[5], entry.lines, soln.knots))
+          stat.set_error("invalid knots");
+        if (stat &&
+            (int)soln.strings.size() != get_num_strings(entry.lines))
+          stat.set_error("invalid number of strings");
+      }
+      else
+        stat.set_error("invalid solution");
+      if (!stat)
+        stat.set_error(msg_str("line %d: %s", line_no, stat.c_msg()));
+      entry.solns.push_back(soln);
+    }
+    else if (num_parts == 5 && strcmp(parts[0], "design") == 0) {
+      entry = Entry();
+      entry.prefer_pure = atoi(parts[1]);
+      entry.only_symmetric = atoi(parts[2]);
+      num_lines = atoi(parts[3]);
+      num_solns = atoi(parts[4]);
+      if (num_lines < 2 || num_lines % 2 || num_solns < 0)
+        stat.set_error(msg_str("line %d: invalid design", line_no));
+    }
+    else
+      stat.set_error(msg_str("line %d: invalid results data", line_no));
+    free(line);
+    if (!stat)
+      break;
+
+    if (num_lines && (int)entry.lines.size() == num_lines &&
+        (int)entry.solns.size() == num_solns) {
+      entries[entry_key(entry.lines, entry.prefer_pure,
+                        entry.only_symmetric)] = entry;
+      num_lines = 0;
+      num_solns = 0;
+    }
+  }
+
+  if (stat && num_lines)
+    stat.set_error("results file is incomplete");
+  return stat;
+}
+
+void ResultCache::write(FILE *ofile) const
+{
+  fprintf(ofile, "%s\n", cache_header);
+  for (const auto &kp : entries) {
+    const Entry &entry = kp.second;
+    fprintf(ofile, "design %d %d %d %d\n", entry.prefer_pure,
+            entry.only_symmetric,
+            (int)entry.lines.size(), (int)entry.solns.size());
+    for (const auto &line : entry.lines)
+      fprintf(ofile, "%s\n", line.c_str());
+    for (const auto &soln : entry.solns)
+      fprintf(ofile, "%s %d %d %d %d %s\n", soln.strings.c_str(),
+              soln.ref.score, soln.ref.strs_no, soln.ref.perm_no,
+              soln.ref.var_no, knots_to_hex(soln.knots).c_str());
+  }
+}
+
+bool ResultCache::find(const KnotColors &k, bool prefer_pure,
+                       bool only_symmetric, SolutionStore &solns) const
+{
+  if (k.num_colours > max_colours)
+    return false;
+
+  const vector<string> lines = get_lines(k);
+  auto it = entries.find(entry_key(lines, prefer_pure, only_symmetric));
+  if (it == entries.end())
+    return false;
+  const Entry &entry = it->second;
+
+  // map the solutions to the canonical form, then to this design
+  int rot, rot_e;
+  bool mir, mir_e;
+  string cols, cols_e;
+  canonical_design(lines, &rot, &mir, &cols);
+  canonical_design(entry.lines, &rot_e, &mir_e, &cols_e);
+  const int num_lines = lines.size();
+  const bool same = (lines == entry.lines);
+  vector<Solution> found;
+  for (const auto &soln : entry.solns) {
+    Solution s = soln;
+    for (char &c : s.strings)
+      c = cols[cols_e.find(c)];
+    if (!same) {
+      s = transform_solution(s, rot_e, mir_e);
+      s = transform_solution(s, (num_lines - rot) % num_lines, mir);
+    }
+    found.push_back(s);
+  }
+
+  vector<Pattern> pats(found.size());
+  for (unsigned int i = 0; i < found.size(); i++) {
+    Pattern &pat = pats[i];
+    pat.set_prefer_pure(prefer_pure);
+    for (char c : found[i].strings)
+      pat.strings.push_back(k.get_idx(c));
+    for (const auto &line : found[i].knots) {
+      pat.knots.push_back(vector<int>());
+      for (char c : line)
+        pat.knots.back().push_back(c == '1');
+    }
+    pat.score = found[i].ref.score;
+    pat.soln_strs_no = found[i].ref.strs_no;
+    pat.soln_perm_no = found[i].ref.perm_no;
+    pat.soln_var_no = found[i].ref.var_no;
+    if (!same &&
+        !k.get_start_refs(pat.strings, &pat.soln_strs_no, &pat.soln_perm_no))
+      return false;
+  }
+
+  if (!same) {
+    // put in search order, and number the variations of each permutation
+    auto search_order = [](const Pattern &a, const Pattern &b) {
+      if (a.soln_strs_no != b.soln_strs_no)
+        return a.soln_strs_no < b.soln_strs_no;
+      if (a.soln_perm_no != b.soln_perm_no)
+        return a.soln_perm_no < b.soln_perm_no;
+      return a.knots < b.knots;
+    };
+    std::sort(pats.begin(), pats.end(), search_order);
+    for (unsigned int i = 0; i < pats.size(); i++) {
+      const bool same_perm = i &&
+                             pats[i - 1].soln_strs_no == pats[i].soln_strs_no &&
+                             pats[i - 1].soln_perm_no == pats[i].soln_perm_no;
+      pats[i].soln_var_no = same_perm ? pats[i - 1].soln_var_no + 1 : 0;
+    }
+  }
+
+  solns.init(k, prefer_pure);
+  for (const auto &pat : pats)
+    solns.add(pat, pat.score);
+  return true;
+}
+
+void ResultCache::add(const KnotColors &k, bool prefer_pure,
+                      bool only_symmetric, const SolutionStore &solns)
+{
+  if (k.num_colours > max_colours)
+    return;
+
+  Entry entry;
+  entry.prefer_pure = prefer_pure;
+  entry.only_symmetric = only_symmetric;
+  entry.lines = get_lines(k);
+  for (size_t i = 0; i < solns.size(); i++) {
+    const Pattern pat = solns.get(i);
+    Solution soln;
+    for (int str : pat.strings)
+      soln.strings += k.get_colour(str);
+    for (const auto &line : pat.knots) {
+      soln.knots.push_back(string());
+      for (int knot : line)
+        soln.knots.back() += knot ? '1' : '0';
+    }
+    soln.ref = solns.get_ref(i);
+    entry.solns.push_back(soln);
+  }
+  entries[entry_key(entry.lines, prefer_pure, only_symmetric)] = entry;
+}
@@ -0,0 +1,117 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file resultcache.h
+   \brief store of solved designs, found whatever their orientation
+*/
+
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include "solutions.h"
+#include "status.h"
+#include <map>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+class KnotColors;
+
+/// Store of the solutions of solved designs
+/** A design is looked up by a canonical form, so it is found when the
+ *  colours are relabelled, the lines are rotated, or the design is
+ *  mirrored left to right. The solutions are held in the orientation and
+ *  colours the design was solved in, and are mapped to those of the
+ *  design being looked up. */
+class ResultCache {
+public:
+  /// A solution, using colour characters
+  struct Solution {
+    std::string strings;            ///< start strings
+    std::vector<std::string> knots; ///< knots of each line, '0' or '1'
+    SolutionStore::Ref ref;         ///< score and reference numbers
+  };
+
+private:
+  struct Entry {
+    bool prefer_pure;
+    bool only_symmetric;
+    std::vector<std::string> lines; // the design as solved
+    std::vector<Solution> solns;
+  };
+  std::map<std::string, Entry> entries;
+
+  static std::string entry_key(const std::vector<std::string> &lines,
+                               bool prefer_pure, bool only_symmetric);
+
+public:
+  /// Read a cache file, adding the entries
+  /**\param ifile the file to read.
+   * \return status, evaluates to \c true if the file was read. */
+  Status read(FILE *ifile);
+
+  /// Write a cache file
+  /**\param ofile the file to write. */
+  void write(FILE *ofile) const;
+
+  /// Find the solutions of a design
+  /** If the design was solved in another orientation then the solutions
+   *  are put in the search order for this orientation, and numbered in
+   *  order within each permutation of the start strings.
+   * \param k the design.
+   * \param prefer_pure whether the solutions prefer pure knots.
+   * \param only_symmetric whether only symmetric solutions were searched.
+   * \param solns used to return the solutions.
+   * \return \c true if the design was found. */
+  bool find(const KnotColors &k, bool prefer_pure, bool only_symmetric,
+            SolutionStore &solns) const;
+
+  /// Add the solutions of a design
+  /**\param k the design.
+   * \param prefer_pure whether the solutions prefer pure knots.
+   * \param only_symmetric whether only symmetric solutions were searched.
+   * \param solns the solutions from a full search of the design. */
+  void add(const KnotColors &k, bool prefer_pure, bool only_symmetric,
+           const SolutionStore &solns);
+
+  /// Get the number of designs held
+  /**\return The number of designs. */
+  size_t size() const { return entries.size(); }
+};
+
+/// Get the canonical form of a design
+/** The design lines are rotated, mirrored, and the colours relabelled
+ *  in order of first appearance. The lines are rotated by line pairs,
+ *  except when mirroring a design with the same number of knots in every
+ *  line, which also swaps the offset of the lines. The form that is first
+ *  in lexicographic order is the canonical form.
+ * \param lines the knot colours of each line.
+ * \param rotate used to return the number of lines the design is rotated
+ *  by to make the canonical form (the line that becomes the first line).
+ * \param mirror used to return whether the design is mirrored.
+ * \param colours used to return the original colour of each canonical
+ *  colour, in order.
+ * \return The canonical form, as text. */
+std::string canonical_design(const std::vector<std::string> &lines,
+                             int *rotate, bool *mirror, std::string *colours);
+
+#endif // RESULTCACHE_H
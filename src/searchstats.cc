@@ -0,0 +1,97 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "searchstats.h"
+#include "utils.h"
+
+void SearchStats::init(int num_lines)
+{
+  lines.assign(num_lines, LineStats{0, 0, 0, 0, 0, 0});
+  permutations = 0;
+  dead_at_first_line = 0;
+  seconds = 0;
+  max_rss_kb = -1;
+}
+
+long SearchStats::descents() const
+{
+  long total = 0;
+  for (const auto &ls : lines)
+    total += ls.descents;
+  return total;
+}
+
+void SearchStats::print(FILE *ofile) const
+{
+  LineStats total = {0, 0, 0, 0, 0, 0};
+  fprintf(ofile, "\nSearch statistics\n\n"
+                 "   line      descents    candidates     redundant       "
+                 "colours         score          wrap\n");
+  for (size_t i = 0; i < lines.size(); i++) {
+    const LineStats &ls = lines[i];
+    fprintf(ofile, "  %5d  %12ld  %12ld  %12ld  %12ld  %12ld  %12ld\n",
+            (int)i + 1, ls.descents, ls.candidates, ls.redundant,
+            ls.colours, ls.score, ls.wrap);
+    total.descents += ls.descents;
+    total.candidates += ls.candidates;
+    total.redundant += ls.redundant;
+    total.colours += ls.colours;
+    total.score += ls.score;
+    total.wrap += ls.wrap;
+  }
+  fprintf(ofile, "  total  %12ld  %12ld  %12ld  %12ld  %12ld  %12ld\n\n",
+          total.descents, total.candidates, total.redundant, total.colours,
+          total.score, total.wrap);
+
+  fprintf(ofile, "permutations searched: %ld, dead at line 1: %ld",
+          permutations, dead_at_first_line);
+  if (permutations)
+    fprintf(ofile, " (%.1f%%)", 100.0 * dead_at_first_line / permutations);
+  fprintf(ofile, "\ndescents: %ld in %.3fs", total.descents, seconds);
+  if (seconds > 0)
+    fprintf(ofile, " (%.0f/s)", total.descents / seconds);
+  fprintf(ofile, "\n");
+  if (max_rss_kb >= 0)
+    fprintf(ofile, "peak memory: %ld kB\n", max_rss_kb);
+}
+
+void SearchStats::print_json(FILE *ofile) const
+{
+  const long total = descents();
+  fprintf(ofile, "{\"lines\":[");
+  for (size_t i = 0; i < lines.size(); i++) {
+    const LineStats &ls = lines[i];
+    fprintf(ofile,
+            "%s{\"line\":%d,\"descents\":%ld,\"candidates\":%ld,"
+            "\"redundant\":%ld,\"colours\":%ld,\"score\":%ld,\"wrap\":%ld}",
+            i ? "," : "", (int)i + 1, ls.descents, ls.candidates,
+            ls.redundant, ls.colours, ls.score, ls.wrap);
+  }
+  fprintf(ofile,
+          "],\"permutations\":%ld,\"dead_at_first_line\":%ld,"
+          "\"dead_share\":%.6g,\"descents\":%ld,\"seconds\":%.6g,"
+          "\"descents_per_sec\":%.6g,\"max_rss_kb\":%ld}\n",
+          permutations, dead_at_first_line,
+          permutations ? (double)dead_at_first_line / permutations : 0.0,
+          total, seconds, seconds > 0 ? total / seconds : 0.0, max_rss_kb);
+}
@@ -0,0 +1,80 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file searchstats.h
+   \brief counters collected from the search, for each knot line
+*/
+
+#ifndef SEARCHSTATS_H
+#define SEARCHSTATS_H
+
+#include <stdio.h>
+#include <vector>
+
+/// Counters for the search of one knot line
+/** Each knotting tried for the line is a candidate. A candidate is
+ *  counted against the first check that rejects it, in the order
+ *  redundant, colours, score and wrap, whichever search made it. */
+struct LineStats {
+  long descents;   ///< times the search entered the line
+  long candidates; ///< knottings of the line tried
+  long redundant;  ///< rejected as knotting same colour strings the
+                   ///< wrong way for the prefered knot type
+  long colours;    ///< rejected as the strings leaving the line don't
+                   ///< meet every knot colour of the next line
+  long score;      ///< rejected as the score is over the limit
+  long wrap;       ///< rejected as the strings leaving the last line
+                   ///< are not the start strings
+};
+
+/// Statistics of a search
+class SearchStats {
+public:
+  std::vector<LineStats> lines; ///< counters for each knot line
+  long permutations;       ///< start string permutations searched
+  long dead_at_first_line; ///< permutations with no knotting of line 1
+                           ///< that passed all the checks
+  double seconds;          ///< time spent searching
+  long max_rss_kb;         ///< peak memory of the process in kilobytes,
+                           ///< or -1 if not known
+
+  /// Constructor
+  SearchStats() { init(0); }
+
+  /// Clear the counters
+  /**\param num_lines the number of knot lines in the design. */
+  void init(int num_lines);
+
+  /// Get the total descents of all the lines
+  /**\return the descents. */
+  long descents() const;
+
+  /// Print the statistics as a table
+  /**\param ofile the file to print to. */
+  void print(FILE *ofile) const;
+
+  /// Print the statistics as a JSON object, on one line
+  /**\param ofile the file to print to. */
+  void print_json(FILE *ofile) const;
+};
+
+#endif // SEARCHSTATS_H
@@ -0,0 +1,357 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "solutioncount.h"
+#include "knotcolors.h"
+#include "pattern.h"
+#include <algorithm>
+#include <unordered_map>
+
+using std::string;
+using std::vector;
+using std::map;
+
+BigCount::BigCount(uint64_t val)
+{
+  while (val) {
+    digits.push_back((uint32_t)val);
+    val >>= 32;
+  }
+}
+
+BigCount &BigCount::operator+=(const BigCount &cnt)
+{
+  if (digits.size() < cnt.digits.size())
+    digits.resize(cnt.digits.size(), 0);
+  uint64_t carry = 0;
+  for (size_t i = 0; i < digits.size(); i++) {
+    if (i >= cnt.digits.size() && !carry)
+      break;
+    uint64_t sum = carry + digits[i];
+    if (i < cnt.digits.size())
+      sum += cnt.digits[i];
+    digits[i] = (uint32_t)sum;
+    carry = sum >> 32;
+  }
+  if (carry)
+    digits.push_back((uint32_t)carry);
+  return *this;
+}
+
+BigCount &BigCount::operator-=(const BigCount &cnt)
+{
+  int64_t borrow = 0;
+  for (size_t i = 0; i < digits.size(); i++) {
+    if (i >= cnt.digits.size() && !borrow)
+      break;
+    int64_t diff = (int64_t)digits[i] - borrow;
+    if (i < cnt.digits.size())
+      diff -= cnt.digits[i];
+    borrow = diff < 0;
+    digits[i] = (uint32_t)(diff + (borrow << 32));
+  }
+  while (!digits.empty() && digits.back() == 0)
+    digits.pop_back();
+  return *this;
+}
+
+BigCount &BigCount::operator*=(uint32_t mult)
+{
+  uint64_t carry = 0;
+  for (size_t i = 0; i < digits.size(); i++) {
+    const uint64_t prod = (uint64_t)digits[i] * mult + carry;
+    digits[i] = (uint32_t)prod;
+    carry = prod >> 32;
+  }
+  if (carry)
+    digits.push_back((uint32_t)carry);
+  if (!mult)
+    digits.clear();
+  return *this;
+}
+
+BigCount &BigCount::operator/=(uint32_t div)
+{
+  uint64_t rem = 0;
+  for (size_t i = digits.size(); i-- > 0;) {
+    const uint64_t cur = (rem << 32) | digits[i];
+    digits[i] = (uint32_t)(cur / div);
+    rem = cur % div;
+  }
+  while (!digits.empty() && digits.back() == 0)
+    digits.pop_back();
+  return *this;
+}
+
+bool BigCount::operator<(const BigCount &cnt) const
+{
+  if (digits.size() != cnt.digits.size())
+    return digits.size() < cnt.digits.size();
+  for (size_t i = digits.size(); i-- > 0;)
+    if (digits[i] != cnt.digits[i])
+      return digits[i] < cnt.digits[i];
+  return false;
+}
+
+uint64_t BigCount::low_bits() const
+{
+  uint64_t val = 0;
+  for (size_t i = std::min(digits.size(), (size_t)2); i-- > 0;)
+    val = (val << 32) | digits[i];
+  return val;
+}
+
+double BigCount::to_double() const
+{
+  double val = 0;
+  for (size_t i = digits.size(); i-- > 0;)
+    val = val * 4294967296.0 + digits[i];
+  return val;
+}
+
+BigCount BigCount::random_below(std::mt19937_64 &rng) const
+{
+  if (is_zero())
+    return BigCount();
+
+  // mask for the bits used in the top digit
+  uint32_t top_mask = digits.back();
+  for (int shift = 1; shift < 32; shift *= 2)
+    top_mask |= top_mask >> shift;
+
+  // try random numbers with the same number of bits until one is lower
+  BigCount rnd;
+  do {
+    rnd.digits.resize(digits.size());
+    for (size_t i = 0; i < digits.size(); i++)
+      rnd.digits[i] = (uint32_t)rng();
+    rnd.digits.back() &= top_mask;
+    while (!rnd.digits.empty() && rnd.digits.back() == 0)
+      rnd.digits.pop_back();
+  } while (!(rnd < *this));
+
+  return rnd;
+}
+
+string BigCount::to_string() const
+{
+  if (is_zero())
+    return "0";
+
+  // divide repeatedly by 10^9, collecting the remainders
+  vector<uint32_t> quot = digits;
+  vector<uint32_t> parts;
+  const uint32_t base = 1000000000;
+  while (!quot.empty()) {
+    uint64_t rem = 0;
+    for (size_t i = quot.size(); i-- > 0;) {
+      const uint64_t cur = (rem << 32) | quot[i];
+      quot[i] = (uint32_t)(cur / base);
+      rem = cur % base;
+    }
+    parts.push_back((uint32_t)rem);
+    while (!quot.empty() && quot.back() == 0)
+      quot.pop_back();
+  }
+
+  string str = std::to_string(parts.back());
+  char buf[16];
+  for (size_t i = parts.size() - 1; i-- > 0;) {
+    sprintf(buf, "%09u", (unsigned int)parts[i]);
+    str += buf;
+  }
+  return str;
+}
+
+void ScoreCounts::add(int score, const BigCount &cnt)
+{
+  if (cnt.is_zero())
+    return;
+  if (only_best && !cnts.empty()) {
+    const int best = cnts.begin()->first;
+    if (score > best)
+      return;
+    if (score < best)
+      cnts.clear();
+  }
+  cnts[score] += cnt;
+}
+
+void ScoreCounts::add(const ScoreCounts &other, int offset, int score_limit)
+{
+  for (const auto &kp : other.cnts) {
+    const int score = kp.first + offset;
+    if (score > score_limit)
+      break;
+    add(score, kp.second);
+  }
+}
+
+int ScoreCounts::best_score() const
+{
+  return cnts.empty() ? INT_MAX : cnts.begin()->first;
+}
+
+// State for trying the knots of a line one knot at a time
+struct LineKnotter {
+  const vector<int> *colours;      // knot colours of the next line
+  const vector<int> *start;        // start strings, or null if not wrapping
+  int first;                       // first string that will be knotted
+  int next_first;                  // first string knotted in the next line
+  int l_cnt;                       // number of knots that may be chosen
+  bool prefer_pure;                // whether pure knots are preferred
+  vector<int> knots;               // knots of the line
+  vector<int> strings_out;         // strings leaving the line
+  vector<vector<int>> next_checks; // next knots to check after each knot
+  vector<vector<int>> wrap_checks; // strings to check after each knot
+  const LineKnotsFunction *fn;
+
+  bool check(int stage) const;
+  void try_knot(int knot, int score);
+};
+
+// Check the strings that are final after knot stage-1 has been tried
+bool LineKnotter::check(int stage) const
+{
+  for (int i : next_checks[stage]) {
+    const int idx = next_first + 2 * i;
+    if ((*colours)[i] != strings_out[idx] &&
+        (*colours)[i] != strings_out[idx + 1])
+      return false;
+  }
+  for (int idx : wrap_checks[stage])
+    if (strings_out[idx] != (*start)[idx])
+      return false;
+  return true;
+}
+
+void LineKnotter::try_knot(int knot, int score)
+{
+  if (knot == (int)knots.size()) {
+    (*fn)(knots, strings_out, score);
+    return;
+  }
+
+  const int idx = first + 2 * knot;
+  const bool equal = strings_out[idx] == strings_out[idx + 1];
+  const int mirror = (int)knots.size() - 1 - knot;
+  for (int swap = 0; swap < 2; swap++) {
+    if (knot >= l_cnt) { // symmetric, so the knot mirrors one on the left
+      if (swap != knots[mirror])
+        continue;
+    }
+    // only count solutions that don't swap strings of the same colour
+    // with the wrong type
+    if (equal && swap != prefer_pure)
+      continue;
+
+    knots[knot] = swap;
+    if (swap)
+      std::swap(strings_out[idx], strings_out[idx + 1]);
+    if (check(knot + 1))
+      try_knot(knot + 1, score + (swap != prefer_pure));
+    if (swap)
+      std::swap(strings_out[idx], strings_out[idx + 1]);
+  }
+}
+
+void for_each_line_knots(const KnotColors &k, int line,
+                         const vector<int> &strings_in,
+                         const vector<int> &start, bool prefer_pure,
+                         bool only_symmetric, const LineKnotsFunction &fn)
+{
+  // The knottings are tried in counter order, one knot at a time. The
+  // strings knotted by a knot are final once it has been tried, and the
+  // checks on them are made then, so that partial knottings that can't
+  // be valid are not continued
+  const int next_line = (line < (int)k.knots.size() - 1) ? line + 1 : 0;
+  const int nk = k.knots[line].size();
+  LineKnotter knotter;
+  knotter.colours = &k.knots[next_line];
+  knotter.start = next_line ? nullptr : &start;
+  knotter.first = line % 2; // first string that will be knotted
+  knotter.next_first = !knotter.first;
+  knotter.l_cnt = only_symmetric ? (nk + 1) / 2 : nk;
+  knotter.prefer_pure = prefer_pure;
+  knotter.knots.assign(nk, 0);
+  knotter.strings_out = strings_in;
+  knotter.fn = &fn;
+
+  // stage at which a string is final: 0 if it isn't knotted in the line,
+  // otherwise after its knot has been tried
+  auto stage = [&](int idx) {
+    const int knot = (idx - knotter.first) / 2;
+    return (idx < knotter.first || knot >= nk) ? 0 : knot + 1;
+  };
+  knotter.next_checks.resize(nk + 1);
+  knotter.wrap_checks.resize(nk + 1);
+  for (unsigned int i = 0; i < knotter.colours->size(); i++) {
+    const int idx = knotter.next_first + 2 * i;
+    knotter.next_checks[std::max(stage(idx), stage(idx + 1))].push_back(i);
+  }
+  if (knotter.start)
+    for (unsigned int idx = 0; idx < strings_in.size(); idx++)
+      knotter.wrap_checks[stage(idx)].push_back(idx);
+
+  if (knotter.check(0))
+    knotter.try_knot(0, 0);
+}
+
+void count_solutions(const KnotColors &k, const vector<int> &strings,
+                     bool prefer_pure, bool only_symmetric, ScoreCounts &cnts,
+                     int score_limit)
+{
+  const bool only_best = cnts.is_only_best();
+  std::unordered_map<string, ScoreCounts> states, next_states;
+  string out_key;
+  ScoreCounts &start_state =
+      states.emplace(string(strings.begin(), strings.end()),
+                     ScoreCounts(only_best))
+          .first->second;
+  start_state.add(0, BigCount(1));
+
+  for (int line = 0; line < (int)k.knots.size() && !states.empty(); line++) {
+    next_states.clear();
+    for (const auto &kp : states) {
+      const ScoreCounts &state = kp.second;
+      auto add_counts = [&](const vector<int> &, const vector<int> &str_out,
+                            int line_score) {
+        if (state.best_score() + line_score > score_limit)
+          return;
+        out_key.assign(str_out.begin(), str_out.end());
+        auto it = next_states.find(out_key);
+        if (it == next_states.end())
+          it = next_states.emplace(out_key, ScoreCounts(only_best)).first;
+        it->second.add(state, line_score, score_limit);
+      };
+      const vector<int> strings_in(kp.first.begin(), kp.first.end());
+      for_each_line_knots(k, line, strings_in, strings, prefer_pure,
+                          only_symmetric, add_counts);
+    }
+    states.swap(next_states);
+  }
+
+  // the only state left has the start strings
+  for (const auto &kp : states)
+    cnts.add(kp.second);
+}
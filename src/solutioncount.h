@@ -0,0 +1,185 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file solutioncount.h
+   \brief count knotting solutions without making them
+*/
+
+#ifndef SOLUTIONCOUNT_H
+#define SOLUTIONCOUNT_H
+
+#include <functional>
+#include <limits.h>
+#include <map>
+#include <random>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class KnotColors;
+
+/// Unsigned integer of arbitrary size, for counting solutions
+class BigCount {
+private:
+  std::vector<uint32_t> digits; // base 2^32, least significant first
+
+public:
+  /// Constructor
+  /**\param val the initial value. */
+  BigCount(uint64_t val = 0);
+
+  /// Add a count
+  /**\param cnt the count to add.
+   * \return a reference to this count. */
+  BigCount &operator+=(const BigCount &cnt);
+
+  /// Subtract a count
+  /**\param cnt the count to subtract, which must not be greater than
+   *  this count.
+   * \return a reference to this count. */
+  BigCount &operator-=(const BigCount &cnt);
+
+  /// Multiply by a number
+  /**\param mult the number to multiply by.
+   * \return a reference to this count. */
+  BigCount &operator*=(uint32_t mult);
+
+  /// Divide by a number, discarding any remainder
+  /**\param div the number to divide by, which must not be zero.
+   * \return a reference to this count. */
+  BigCount &operator/=(uint32_t div);
+
+  /// Compare with a count
+  /**\param cnt the count to compare with.
+   * \return \c true if this count is less than \a cnt. */
+  bool operator<(const BigCount &cnt) const;
+
+  /// Check whether the count is zero
+  /**\return \c true if the count is zero. */
+  bool is_zero() const { return digits.empty(); }
+
+  /// Get the low 64 bits of the count
+  /**\return The count modulo 2^64. */
+  uint64_t low_bits() const;
+
+  /// Get the count as a floating point number
+  /**\return The nearest double to the count. */
+  double to_double() const;
+
+  /// Get a uniformly distributed random count less than this count
+  /**\param rng the random number generator.
+   * \return The random count, or zero if this count is zero. */
+  BigCount random_below(std::mt19937_64 &rng) const;
+
+  /// Convert the count to a decimal string
+  /**\return The string. */
+  std::string to_string() const;
+};
+
+/// Numbers of solutions, by score
+/** Either every score is counted, or only the best (lowest) score, in
+ *  which case adding a count for a better score removes the others, and
+ *  counts for worse scores are ignored. */
+class ScoreCounts {
+private:
+  std::map<int, BigCount> cnts;
+  bool only_best;
+
+public:
+  /// Constructor
+  /**\param best whether to only count the best score. */
+  ScoreCounts(bool best = true) : only_best(best) {}
+
+  /// Add a count for a score
+  /**\param score the score.
+   * \param cnt the number of solutions with the score. */
+  void add(int score, const BigCount &cnt);
+
+  /// Add all the counts of another set of counts
+  /**\param other the counts to add.
+   * \param offset added to the scores of \a other.
+   * \param score_limit counts with a score (after the offset) greater
+   *  than this are ignored. */
+  void add(const ScoreCounts &other, int offset = 0,
+           int score_limit = INT_MAX);
+
+  /// Get the best score
+  /**\return the lowest score counted, or \c INT_MAX if there are no
+   *  counts. */
+  int best_score() const;
+
+  /// Check whether only the best score is counted
+  /**\return \c true if only the best score is counted. */
+  bool is_only_best() const { return only_best; }
+
+  /// Check whether there are any counts
+  /**\return \c true if there are no counts. */
+  bool empty() const { return cnts.empty(); }
+
+  /// Get the counts
+  /**\return the number of solutions of each score, by score. */
+  const std::map<int, BigCount> &get_counts() const { return cnts; }
+};
+
+/// Function called for a knotting of a line
+/** It is passed the knots of the line, the strings leaving the line and the
+ *  score of the line. */
+typedef std::function<void(const std::vector<int> &, const std::vector<int> &,
+                           int)>
+    LineKnotsFunction;
+
+/// Call a function for each valid knotting of a line
+/** The knottings are tried in the order, and with the same tests (except
+ *  for the score limit), as Pattern::check_line().
+ * \param k the design.
+ * \param line the line number.
+ * \param strings_in the strings entering the line.
+ * \param start the start strings, which the strings leaving the last line
+ *  must match.
+ * \param prefer_pure whether pure knots are preferred.
+ * \param only_symmetric only try symmetric knottings.
+ * \param fn the function to call for each valid knotting. */
+void for_each_line_knots(const KnotColors &k, int line,
+                         const std::vector<int> &strings_in,
+                         const std::vector<int> &start, bool prefer_pure,
+                         bool only_symmetric, const LineKnotsFunction &fn);
+
+/// Count the knotting solutions for a set of start strings
+/** The count is made line by line. The knotting paths that lead to the
+ *  same strings at the end of a line are merged into a single state,
+ *  holding the numbers of paths by score, so solutions are never
+ *  enumerated. The solutions counted are the same as those found by
+ *  Pattern::check_line().
+ * \param k the design.
+ * \param strings the start strings.
+ * \param prefer_pure whether pure knots are preferred.
+ * \param only_symmetric only count symmetric knottings.
+ * \param cnts used to return the counts (and determines whether all
+ *  scores or only the best score is counted). Counts are added to
+ *  any counts it already holds.
+ * \param score_limit knottings with a score greater than this are not
+ *  counted. */
+void count_solutions(const KnotColors &k, const std::vector<int> &strings,
+                     bool prefer_pure, bool only_symmetric, ScoreCounts &cnts,
+                     int score_limit = INT_MAX);
+
+#endif // SOLUTIONCOUNT_H
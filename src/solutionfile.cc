@@ -0,0 +1,305 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file solutionfile.cc
+   \brief compact binary file of knotting solutions
+*/
+
+#include "solutionfile.h"
+#include "knotcolors.h"
+#include "pattern.h"
+#include "solutions.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace {
+
+const char solution_file_magic[8] = {'B', 'R', 'S', 'O', 'L', 'N', '0', '1'};
+
+// Numbers are appended to a buffer, which is written out in blocks
+class BinaryWriter {
+private:
+  FILE *ofile;
+  string buf;
+  bool failed;
+
+public:
+  BinaryWriter(FILE *file) : ofile(file), failed(false) {}
+
+  void put_bytes(const void *data, size_t len)
+  {
+    buf.append(static_cast<const char *>(data), len);
+    if (buf.size() >= 1 << 16)
+      flush();
+  }
+
+  void put_u8(unsigned int val) { buf += (char)val; }
+
+  void put_u32(uint32_t val)
+  {
+    for (int i = 0; i < 4; i++)
+      buf += (char)(val >> (8 * i));
+  }
+
+  void put_u64(uint64_t val)
+  {
+    for (int i = 0; i < 8; i++)
+      buf += (char)(val >> (8 * i));
+    if (buf.size() >= 1 << 16)
+      flush();
+  }
+
+  bool flush()
+  {
+    if (buf.size() && fwrite(buf.data(), 1, buf.size(), ofile) != buf.size())
+      failed = true;
+    buf.clear();
+    return !failed;
+  }
+};
+
+// The sizes read are checked against the bytes left in the file, if
+// the file can be seeked, before anything is made for them
+class BinaryReader {
+private:
+  FILE *ifile;
+  uint64_t left; // bytes left to read, UINT64_MAX if not known
+
+public:
+  BinaryReader(FILE *file) : ifile(file), left(UINT64_MAX)
+  {
+    const long start = ftell(ifile);
+    if (start >= 0 && fseek(ifile, 0, SEEK_END) == 0) {
+      const long end = ftell(ifile);
+      if (fseek(ifile, start, SEEK_SET) == 0 && end >= start)
+        left = end - start;
+    }
+  }
+
+  // whether num items of size bytes may be left to read
+  bool has_bytes(uint64_t num, uint64_t size = 1) const
+  {
+    return num <= left / size;
+  }
+
+  bool get_bytes(void *data, size_t len)
+  {
+    if (!has_bytes(len) || fread(data, 1, len, ifile) != len)
+      return false;
+    if (left != UINT64_MAX)
+      left -= len;
+    return true;
+  }
+
+  bool get_u8(unsigned int *val)
+  {
+    unsigned char c;
+    if (!get_bytes(&c, 1))
+      return false;
+    *val = c;
+    return true;
+  }
+
+  bool get_u32(uint32_t *val)
+  {
+    unsigned char b[4];
+    if (!get_bytes(b, 4))
+      return false;
+    *val = 0;
+    for (int i = 3; i >= 0; i--)
+      *val = (*val << 8) | b[i];
+    return true;
+  }
+
+  bool get_u64(uint64_t *val)
+  {
+    unsigned char b[8];
+    if (!get_bytes(b, 8))
+      return false;
+    *val = 0;
+    for (int i = 7; i >= 0; i--)
+      *val = (*val << 8) | b[i];
+    return true;
+  }
+};
+
+} // namespace
+
+uint64_t design_hash(const KnotColors &k)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  auto add = [&hash](char c) {
+    hash ^= (unsigned char)c;
+    hash *= 1099511628211ULL;
+  };
+  for (const auto &line : k.knots) {
+    for (int knot : line)
+      add(k.get_colour(knot));
+    add('\n');
+  }
+  return hash;
+}
+
+Status write_solution_file(FILE *ofile, const KnotColors &k,
+                           const SolutionStore &solns)
+{
+  BinaryWriter out(ofile);
+  out.put_bytes(solution_file_magic, sizeof(solution_file_magic));
+  out.put_u64(design_hash(k));
+  out.put_u8(solns.get_prefer_pure());
+  out.put_u32(k.num_colours);
+  for (int i = 0; i < k.num_colours; i++)
+    out.put_u8(k.get_colour(i));
+  out.put_u32(k.knots.size());
+  for (const auto &line : k.knots) {
+    out.put_u32(line.size());
+    for (int knot : line)
+      out.put_u8(knot);
+  }
+  out.put_u32(k.num_strings);
+
+  int sol_words = 0;
+  for (unsigned int i = 0; i < k.knots.size(); i++)
+    sol_words += solns.get_line_words(i);
+  out.put_u64(solns.size());
+  for (size_t i = 0; i < solns.size(); i++) {
+    const SolutionStore::Ref &ref = solns.get_ref(i);
+    out.put_u32(ref.score);
+    out.put_u32(ref.strs_no);
+    out.put_u32(ref.perm_no);
+    out.put_u32(ref.var_no);
+    out.put_bytes(solns.get_strings(i), k.num_strings);
+    const uint64_t *knots = solns.get_knots(i);
+    for (int w = 0; w < sol_words; w++)
+      out.put_u64(knots[w]);
+  }
+
+  if (!out.flush())
+    return Status::error("could not write solution file");
+  return Status::ok();
+}
+
+Status read_solution_file(FILE *ifile, KnotColors &k, SolutionStore &solns)
+{
+  BinaryReader in(ifile);
+  const Status truncated = Status::error("solution file is truncated");
+  char magic[sizeof(solution_file_magic)];
+  if (!in.get_bytes(magic, sizeof(magic)) ||
+      !std::equal(magic, magic + sizeof(magic), solution_file_magic))
+    return Status::error("not a solution file, or unknown version");
+
+  uint64_t hash;
+  unsigned int pure;
+  uint32_t num_colours;
+  if (!in.get_u64(&hash) || !in.get_u8(&pure) || !in.get_u32(&num_colours))
+    return truncated;
+  if (num_colours < 1 || num_colours > 256) // colours are single characters
+    return Status::error(msg_str("number of colours is %lu, must be from 1 "
+                                 "to 256",
+                                 (unsigned long)num_colours));
+  string colours(num_colours, ' ');
+  if (!in.get_bytes(&colours[0], num_colours))
+    return truncated;
+
+  // each line has its number of knots, and then a byte for each knot
+  uint32_t num_lines;
+  if (!in.get_u32(&num_lines))
+    return truncated;
+  if (!in.has_bytes(num_lines, 4))
+    return truncated;
+  vector<string> lines;
+  for (uint32_t i = 0; i < num_lines; i++) {
+    uint32_t num_knots;
+    if (!in.get_u32(&num_knots) || !in.has_bytes(num_knots))
+      return truncated;
+    string line;
+    for (uint32_t j = 0; j < num_knots; j++) {
+      unsigned int knot;
+      if (!in.get_u8(&knot))
+        return truncated;
+      if (knot >= num_colours)
+        return Status::error(
+            msg_str("line %d: knot colour is not in the colour table", i + 1));
+      line += colours[knot];
+    }
+    lines.push_back(line);
+  }
+
+  Status stat = k.read(lines);
+  if (!stat)
+    return Status::error(msg_str("design: %s", stat.c_msg()));
+  for (uint32_t i = 0; i < num_colours; i++)
+    if (k.get_colour(i) != colours[i])
+      return Status::error("colour table does not match the design");
+  if (design_hash(k) != hash)
+    return Status::error("design does not match its hash");
+
+  uint32_t num_strings;
+  if (!in.get_u32(&num_strings))
+    return truncated;
+  if ((int)num_strings != k.num_strings)
+    return Status::error("number of strings does not match the design");
+
+  solns.init(k, pure);
+  int sol_words = 0;
+  for (unsigned int i = 0; i < k.knots.size(); i++)
+    sol_words += solns.get_line_words(i);
+  vector<unsigned char> strings(num_strings);
+  vector<uint64_t> knots(sol_words);
+  Pattern pat;
+  pat.strings.resize(num_strings);
+
+  uint64_t num_solns;
+  if (!in.get_u64(&num_solns))
+    return truncated;
+  if (!in.has_bytes(num_solns, 4 * 4 + num_strings + 8 * sol_words))
+    return truncated;
+  for (uint64_t i = 0; i < num_solns; i++) {
+    uint32_t ref[4];
+    for (auto &val : ref)
+      if (!in.get_u32(&val))
+        return truncated;
+    if (!in.get_bytes(strings.data(), num_strings))
+      return truncated;
+    for (auto &word : knots)
+      if (!in.get_u64(&word))
+        return truncated;
+    for (uint32_t j = 0; j < num_strings; j++) {
+      if (strings[j] >= num_colours)
+        return Status::error(msg_str("solution %lu: string colour is not in "
+                                     "the colour table",
+                                     (unsigned long)i));
+      pat.strings[j] = strings[j];
+    }
+    pat.soln_strs_no = ref[1];
+    pat.soln_perm_no = ref[2];
+    pat.soln_var_no = ref[3];
+    solns.add(pat, (int)ref[0], knots.data());
+  }
+  return Status::ok();
+}
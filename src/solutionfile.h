@@ -0,0 +1,67 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file solutionfile.h
+   \brief compact binary file of knotting solutions
+*/
+
+#ifndef SOLUTIONFILE_H
+#define SOLUTIONFILE_H
+
+#include "status.h"
+#include <stdint.h>
+#include <stdio.h>
+
+class KnotColors;
+class SolutionStore;
+
+/// Get a hash of the knot colours of a design
+/** The hash is a 64 bit FNV-1a hash of the knot lines, as colour
+ *  characters, so it identifies the design whatever order its colours
+ *  were numbered in.
+ * \param k the design.
+ * \return the hash. */
+uint64_t design_hash(const KnotColors &k);
+
+/// Write solutions to a binary solution file
+/** The file holds the design, as a hash, a colour table and the knot
+ *  colours of each line, followed by the solutions as held in a
+ *  SolutionStore: the reference numbers and score, the start strings,
+ *  one byte per string, and the knots of each line, packed into 64 bit
+ *  words. All numbers are written little-endian. The file is many times
+ *  smaller than a text report, and the report can be made from it when
+ *  needed.
+ * \param ofile the file to write, opened in binary mode.
+ * \param k the design.
+ * \param solns the solutions of the design.
+ * \return status, evaluates to \c true if the file was written. */
+Status write_solution_file(FILE *ofile, const KnotColors &k,
+                           const SolutionStore &solns);
+
+/// Read a binary solution file
+/**\param ifile the file to read, opened in binary mode.
+ * \param k used to return the design.
+ * \param solns used to return the solutions.
+ * \return status, evaluates to \c true if the file was read. */
+Status read_solution_file(FILE *ifile, KnotColors &k, SolutionStore &solns);
+
+#endif // SOLUTIONFILE_H
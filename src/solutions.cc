@@ -0,0 +1,133 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "solutions.h"
+#include "knotcolors.h"
+#include "pattern.h"
+
+using std::vector;
+
+SolutionStore::SolutionStore()
+    : num_strings(0), prefer_pure(true), sol_words(0)
+{
+}
+
+void SolutionStore::init(const KnotColors &k, bool pure)
+{
+  clear();
+  num_strings = k.num_strings;
+  prefer_pure = pure;
+  line_knots.resize(k.knots.size());
+  line_start.resize(k.knots.size());
+  sol_words = 0;
+  for (unsigned int i = 0; i < k.knots.size(); i++) {
+    line_knots[i] = k.knots[i].size();
+    line_start[i] = sol_words;
+    sol_words += get_line_words(i);
+  }
+}
+
+void SolutionStore::clear()
+{
+  strings.clear();
+  knots.clear();
+  refs.clear();
+}
+
+void SolutionStore::truncate(size_t sz)
+{
+  if (sz >= size())
+    return;
+  strings.resize(sz * num_strings);
+  knots.resize(sz * sol_words);
+  refs.resize(sz);
+}
+
+void SolutionStore::erase_front(size_t cnt)
+{
+  if (cnt >= size()) {
+    clear();
+    return;
+  }
+  strings.erase(strings.begin(), strings.begin() + cnt * num_strings);
+  knots.erase(knots.begin(), knots.begin() + cnt * sol_words);
+  refs.erase(refs.begin(), refs.begin() + cnt);
+}
+
+int SolutionStore::get_line_words(int line) const
+{
+  return (line_knots[line] + 63) / 64;
+}
+
+void SolutionStore::add(const Pattern &pat, int score,
+                        const uint64_t *packed_knots)
+{
+  for (int i = 0; i < num_strings; i++)
+    strings.push_back(pat.strings[i]);
+
+  if (packed_knots)
+    knots.insert(knots.end(), packed_knots, packed_knots + sol_words);
+  else {
+    for (unsigned int i = 0; i < line_knots.size(); i++) {
+      const vector<int> &knots_line = pat.knots[i];
+      for (int w = 0; w < line_knots[i]; w += 64) {
+        uint64_t word = 0;
+        for (int j = w; j < line_knots[i] && j < w + 64; j++)
+          word = (word << 1) | (knots_line[j] != 0);
+        knots.push_back(word);
+      }
+    }
+  }
+
+  Ref ref = {score, pat.soln_strs_no, pat.soln_perm_no, pat.soln_var_no};
+  refs.push_back(ref);
+}
+
+Pattern SolutionStore::get(size_t idx) const
+{
+  Pattern pat;
+  pat.set_prefer_pure(prefer_pure);
+  const unsigned char *strs = get_strings(idx);
+  pat.strings.assign(strs, strs + num_strings);
+
+  const uint64_t *sol_knots = get_knots(idx);
+  pat.knots.resize(line_knots.size());
+  for (unsigned int i = 0; i < line_knots.size(); i++) {
+    const int nk = line_knots[i];
+    vector<int> &knots_line = pat.knots[i];
+    knots_line.resize(nk);
+    const uint64_t *words = sol_knots + line_start[i];
+    for (int j = 0; j < nk; j++) {
+      const int w = j / 64;
+      const int bits = (nk - 64 * w < 64) ? nk - 64 * w : 64;
+      knots_line[j] = (words[w] >> (bits - 1 - j % 64)) & 1;
+    }
+  }
+
+  const Ref &ref = refs[idx];
+  pat.score = ref.score;
+  pat.soln_strs_no = ref.strs_no;
+  pat.soln_perm_no = ref.perm_no;
+  pat.soln_var_no = ref.var_no;
+  return pat;
+}
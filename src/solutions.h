@@ -0,0 +1,138 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file solutions.h
+   \brief compact store of knotting solutions
+*/
+
+#ifndef SOLUTIONS_H
+#define SOLUTIONS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+class KnotColors;
+class Pattern;
+
+/// Compact store of knotting solutions
+/** The solutions are held in arenas: the start strings of each solution
+ *  as one byte per string, and the knots of each line packed as bits
+ *  into 64 bit words. The bits of a word are a binary number, with the
+ *  first knot of the word in the highest bit used. A Pattern is only
+ *  made for a solution when it is needed, e.g. for printing. */
+class SolutionStore {
+public:
+  /// Reference numbers and score of a solution
+  struct Ref {
+    int score;   ///< score
+    int strs_no; ///< set of free colours
+    int perm_no; ///< permutation of free colours
+    int var_no;  ///< knotting variation of a permutation
+  };
+
+private:
+  int num_strings;
+  bool prefer_pure;
+  std::vector<int> line_knots; // number of knots in each line
+  std::vector<int> line_start; // index of first word of each line
+  int sol_words;               // words for the knots of a solution
+
+  std::vector<unsigned char> strings;
+  std::vector<uint64_t> knots;
+  std::vector<Ref> refs;
+
+public:
+  /// Constructor
+  SolutionStore();
+
+  /// Initialise the store for a design, removing all solutions
+  /**\param k the design.
+   * \param pure whether the solutions prefer pure knots. */
+  void init(const KnotColors &k, bool pure);
+
+  /// Remove all the solutions
+  void clear();
+
+  /// Remove solutions from the end
+  /**\param sz the number of solutions to keep. */
+  void truncate(size_t sz);
+
+  /// Remove solutions from the start
+  /**\param cnt the number of solutions to remove. */
+  void erase_front(size_t cnt);
+
+  /// Get the number of solutions
+  /**\return the number of solutions. */
+  size_t size() const { return refs.size(); }
+
+  /// Get whether the solutions prefer pure knots
+  /**\return \c true if pure knots are preferred. */
+  bool get_prefer_pure() const { return prefer_pure; }
+
+  /// Get the score of a solution
+  /**\param idx the solution index.
+   * \return the score. */
+  int score(size_t idx) const { return refs[idx].score; }
+
+  /// Get the reference numbers and score of a solution
+  /**\param idx the solution index.
+   * \return the reference. */
+  const Ref &get_ref(size_t idx) const { return refs[idx]; }
+
+  /// Get the number of 64 bit words used to hold the knots of a line
+  /**\param line the line number.
+   * \return the number of words. */
+  int get_line_words(int line) const;
+
+  /// Get the knots of a solution
+  /**\param idx the solution index.
+   * \return a pointer to the packed knots, line by line. */
+  const uint64_t *get_knots(size_t idx) const
+  {
+    return &knots[idx * sol_words];
+  }
+
+  /// Get the start strings of a solution
+  /**\param idx the solution index.
+   * \return a pointer to the strings. */
+  const unsigned char *get_strings(size_t idx) const
+  {
+    return &strings[idx * num_strings];
+  }
+
+  /// Add a solution
+  /**\param pat the pattern, with start strings and reference numbers.
+   * \param score the score of the solution.
+   * \param packed_knots the knots of each line, packed, or \c nullptr to
+   *  pack the knots of \a pat. */
+  void add(const Pattern &pat, int score,
+           const uint64_t *packed_knots = nullptr);
+
+  /// Make a pattern for a solution
+  /**\param idx the solution index.
+   * \return the pattern. */
+  Pattern get(size_t idx) const;
+};
+
+#endif // SOLUTIONS_H
@@ -0,0 +1,196 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "solvecache.h"
+#include "knotcolors.h"
+#include "solutioncount.h"
+#include "utils.h"
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <unordered_set>
+
+using std::string;
+using std::vector;
+
+static const char cache_header[] = "bracelet_solver cache 1";
+
+SolveCache::SolveCache() : only_symmetric(false) {}
+
+Status SolveCache::read(FILE *ifile)
+{
+  lines.clear();
+  passed.clear();
+
+  Status stat;
+  char *line = nullptr;
+  vector<char *> parts;
+  int line_no = 0;
+  int num_lines = -1;
+  while (read_line(ifile, &line) == 0) {
+    line_no++;
+    if (line_no == 1) {
+      if (strcmp(line, cache_header))
+        stat.set_error("not a cache file, or unknown version");
+      free(line);
+      if (!stat)
+        break;
+      continue;
+    }
+    const int num_parts = split_line(line, parts);
+    if (num_parts == 2 && strcmp(parts[0], "symmetric") == 0)
+      only_symmetric = atoi(parts[1]);
+    else if (num_parts == 2 && strcmp(parts[0], "lines") == 0)
+      num_lines = atoi(parts[1]);
+    else if (num_parts == 1 && (int)lines.size() < num_lines)
+      lines.push_back(parts[0]);
+    else if (num_parts == 2 && (int)lines.size() == num_lines)
+      passed[parts[0]] = atoi(parts[1]);
+    else
+      stat.set_error(msg_str("line %d: invalid cache data", line_no));
+    free(line);
+    if (!stat)
+      break;
+  }
+
+  if (stat && (num_lines < 0 || (int)lines.size() != num_lines))
+    stat.set_error("cache file is incomplete");
+  if (!stat) {
+    lines.clear();
+    passed.clear();
+  }
+  return stat;
+}
+
+void SolveCache::write(FILE *ofile) const
+{
+  fprintf(ofile, "%s\n", cache_header);
+  fprintf(ofile, "symmetric %d\n", only_symmetric);
+  fprintf(ofile, "lines %d\n", (int)lines.size());
+  for (const auto &line : lines)
+    fprintf(ofile, "%s\n", line.c_str());
+  for (const auto &kp : passed)
+    fprintf(ofile, "%s %d\n", kp.first.c_str(), kp.second);
+}
+
+bool SolveCache::set_design(const KnotColors &k, bool symmetric)
+{
+  vector<string> new_lines(k.knots.size());
+  for (unsigned int i = 0; i < k.knots.size(); i++)
+    for (unsigned int j = 0; j < k.knots[i].size(); j++)
+      new_lines[i] += k.get_colour(k.knots[i][j]);
+
+  // the lines must be the same length, and the colours of the strings
+  // are only comparable if the design has the same colours
+  bool reuse = (symmetric == only_symmetric) &&
+               (new_lines.size() == lines.size());
+  for (unsigned int i = 0; reuse && i < lines.size(); i++)
+    reuse = (new_lines[i].size() == lines[i].size());
+  if (reuse) {
+    string old_cols, new_cols;
+    for (unsigned int i = 0; i < lines.size(); i++) {
+      old_cols += lines[i];
+      new_cols += new_lines[i];
+    }
+    std::sort(old_cols.begin(), old_cols.end());
+    std::sort(new_cols.begin(), new_cols.end());
+    old_cols.erase(std::unique(old_cols.begin(), old_cols.end()),
+                   old_cols.end());
+    new_cols.erase(std::unique(new_cols.begin(), new_cols.end()),
+                   new_cols.end());
+    reuse = (old_cols == new_cols);
+  }
+
+  changed.assign(new_lines.size(), false);
+  if (reuse) {
+    for (unsigned int i = 0; i < lines.size(); i++)
+      changed[i] = (lines[i] != new_lines[i]);
+  }
+  else
+    passed.clear();
+
+  only_symmetric = symmetric;
+  lines = new_lines;
+  return reuse;
+}
+
+// The strings failing at a line depend on the start strings, and on the
+// colours of the lines up to the line after, or the first line and the
+// wrap if the line is the last line
+bool SolveCache::unchanged_to(int line) const
+{
+  const int last_line = (int)changed.size() - 1;
+  if (line >= last_line)
+    return std::find(changed.begin(), changed.end(), true) == changed.end();
+  for (int i = 1; i <= line + 1; i++)
+    if (changed[i])
+      return false;
+  return true;
+}
+
+string SolveCache::strings_key(const KnotColors &k,
+                               const vector<int> &strings) const
+{
+  string key;
+  for (int str : strings)
+    key += k.get_colour(str);
+  return key;
+}
+
+bool SolveCache::needs_search(const KnotColors &k, const vector<int> &strings)
+{
+  const int num_lines = k.knots.size();
+  const string key = strings_key(k, strings);
+  auto it = passed.find(key);
+  if (it != passed.end() && it->second < num_lines &&
+      unchanged_to(it->second))
+    return false; // still fails at the same line
+
+  const int num_passed = lines_passed(k, strings, only_symmetric);
+  passed[key] = num_passed;
+  return num_passed == num_lines;
+}
+
+int lines_passed(const KnotColors &k, const vector<int> &strings,
+                 bool only_symmetric)
+{
+  std::unordered_set<string> states, next_states;
+  states.insert(string(strings.begin(), strings.end()));
+  const int num_lines = k.knots.size();
+  for (int line = 0; line < num_lines; line++) {
+    next_states.clear();
+    for (const auto &key : states) {
+      auto add_state = [&](const vector<int> &, const vector<int> &str_out,
+                           int) {
+        next_states.insert(string(str_out.begin(), str_out.end()));
+      };
+      const vector<int> strings_in(key.begin(), key.end());
+      for_each_line_knots(k, line, strings_in, strings, true, only_symmetric,
+                          add_state);
+    }
+    if (next_states.empty())
+      return line;
+    states.swap(next_states);
+  }
+  return num_lines;
+}
@@ -0,0 +1,101 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file solvecache.h
+   \brief data saved from a solve, to speed up solving an edited design
+*/
+
+#ifndef SOLVECACHE_H
+#define SOLVECACHE_H
+
+#include "status.h"
+#include <stdio.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class KnotColors;
+
+/// Data from solving a design, reused to solve an edited design
+/** For each set of start strings the cache holds the number of knot
+ *  lines that can be passed by some knotting, ignoring the score. The
+ *  strings survive if every line can be passed, and wrap back to the
+ *  start strings. Whether a line can be passed only depends on the start
+ *  strings and the knot colours up to the next line, so when a design is
+ *  edited the start strings that failed before the first edited line
+ *  still fail, and need not be searched again. The cache also holds the
+ *  design it was made for. */
+class SolveCache {
+private:
+  bool only_symmetric;
+  std::vector<std::string> lines;              // knot colours of the design
+  std::vector<bool> changed;                   // lines changed by an edit
+  std::unordered_map<std::string, int> passed; // lines passed, by strings
+
+  std::string strings_key(const KnotColors &k,
+                          const std::vector<int> &strings) const;
+  bool unchanged_to(int line) const;
+
+public:
+  /// Constructor
+  SolveCache();
+
+  /// Read a cache file
+  /**\param ifile the file to read.
+   * \return status, evaluates to \c true if the cache was read. */
+  Status read(FILE *ifile);
+
+  /// Write a cache file
+  /**\param ofile the file to write. */
+  void write(FILE *ofile) const;
+
+  /// Set the design being solved
+  /** The lines that differ from the cached design are found. If the
+   *  design can't reuse the cached data then the cache is cleared.
+   * \param k the design.
+   * \param symmetric whether only symmetric solutions are searched for.
+   * \return \c true if cached data may be reused. */
+  bool set_design(const KnotColors &k, bool symmetric);
+
+  /// Check whether a set of start strings needs to be searched
+  /** If there is no valid cached data for the strings then the number of
+   *  lines passed is found, and stored.
+   * \param k the design.
+   * \param strings the start strings.
+   * \return \c true if the strings survive, and must be searched. */
+  bool needs_search(const KnotColors &k, const std::vector<int> &strings);
+};
+
+/// Get the number of knot lines that can be passed by start strings
+/** The knottings of each line are followed from the strings leaving the
+ *  line above, with the strings leaving a line merged into a set, so the
+ *  result does not depend on the score, or whether pure or mixed knots
+ *  are preferred.
+ * \param k the design.
+ * \param strings the start strings.
+ * \param only_symmetric only follow symmetric knottings.
+ * \return The number of lines passed. This is the number of lines if
+ *  the strings can return to the start strings. */
+int lines_passed(const KnotColors &k, const std::vector<int> &strings,
+                 bool only_symmetric);
+
+#endif // SOLVECACHE_H
@@ -0,0 +1,81 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "threadpool.h"
+
+ThreadPool::ThreadPool(int num_threads)
+    : num_added(0), num_running(0), stopping(false)
+{
+  if (num_threads < 1)
+    num_threads = std::thread::hardware_concurrency();
+  if (num_threads < 1)
+    num_threads = 1;
+  for (int i = 0; i < num_threads; i++)
+    workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    stopping = true;
+  }
+  task_ready.notify_all();
+  for (auto &worker : workers)
+    worker.join();
+}
+
+void ThreadPool::add(Task task, int priority)
+{
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    tasks.push(Item{priority, num_added++, std::move(task)});
+  }
+  task_ready.notify_one();
+}
+
+void ThreadPool::wait()
+{
+  std::unique_lock<std::mutex> lock(mtx);
+  all_done.wait(lock, [this] { return tasks.empty() && !num_running; });
+}
+
+// Workers finish the tasks waiting before they stop
+void ThreadPool::work()
+{
+  std::unique_lock<std::mutex> lock(mtx);
+  while (true) {
+    task_ready.wait(lock, [this] { return stopping || !tasks.empty(); });
+    if (tasks.empty())
+      return;
+    Task task = tasks.top().task;
+    tasks.pop();
+    num_running++;
+    lock.unlock();
+    task();
+    lock.lock();
+    num_running--;
+    if (tasks.empty() && !num_running)
+      all_done.notify_all();
+  }
+}
@@ -0,0 +1,93 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file threadpool.h
+   \brief pool of worker threads running tasks in priority order
+*/
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/// Pool of worker threads
+/** Tasks are run by the first free worker, highest priority first, and
+ *  in the order they were added for equal priorities. */
+class ThreadPool {
+public:
+  /// A task to run
+  typedef std::function<void()> Task;
+
+private:
+  struct Item {
+    int priority;
+    long seq;
+    Task task;
+    bool operator<(const Item &other) const
+    {
+      return (priority != other.priority) ? priority < other.priority
+                                          : seq > other.seq;
+    }
+  };
+
+  std::vector<std::thread> workers;
+  std::priority_queue<Item> tasks;
+  std::mutex mtx;
+  std::condition_variable task_ready;
+  std::condition_variable all_done;
+  long num_added;
+  int num_running;
+  bool stopping;
+
+  void work();
+
+public:
+  /// Constructor
+  /**\param num_threads the number of worker threads, or \c 0 to use the
+   *  number of hardware threads. */
+  explicit ThreadPool(int num_threads = 0);
+
+  /// Destructor, waits for all the tasks to finish
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /// Add a task
+  /**\param task the task.
+   * \param priority tasks with a higher priority run first. */
+  void add(Task task, int priority = 0);
+
+  /// Wait until all the tasks added have finished
+  void wait();
+
+  /// Get the number of worker threads
+  /**\return The number of threads. */
+  int size() const { return workers.size(); }
+};
+
+#endif // THREADPOOL_H
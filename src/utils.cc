@@ -42,6 +42,12 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <vector>
+#ifdef HAVE_SYS_RESOURCE_H
+#include <sys/resource.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
 
 #include "utils.h"
 
@@ -63,6 +69,18 @@ Status read_int(const char *str, int *i)
   return Status::ok();
 }
 
+Status read_double(const char *str, double *f)
+{
+  char buff;
+  if (sscanf(str, " %lf %c", f, &buff) != 1)
+    return Status::error("not a number");
+
+  if (!std::isfinite(*f))
+    return Status::error("number is not finite");
+
+  return Status::ok();
+}
+
 int read_line(FILE *file, char **line)
 {
 
@@ -155,6 +173,31 @@ FILE *fopen_file(string &fpath)
   return file;
 }
 
+Status replace_file(const string &fpath,
+                    const std::function<void(FILE *)> &write_fn)
+{
+  // a name of its own for each process, in the same directory as the file
+  // so the rename does not cross file systems
+  string tmp_path = fpath + ".tmp";
+#ifdef HAVE_UNISTD_H
+  tmp_path += std::to_string((long)getpid());
+#endif
+  FILE *ofile = fopen(tmp_path.c_str(), "w");
+  if (!ofile)
+    return Status::error("could not open temporary file");
+  write_fn(ofile);
+  const bool written = !ferror(ofile);
+  if (fclose(ofile) != 0 || !written) {
+    remove(tmp_path.c_str());
+    return Status::error("could not write temporary file");
+  }
+  if (rename(tmp_path.c_str(), fpath.c_str()) != 0) {
+    remove(tmp_path.c_str());
+    return Status::error("could not rename temporary file");
+  }
+  return Status::ok();
+}
+
 string msg_str(const char *fmt, ...)
 {
   char message[MSG_SZ];
@@ -163,3 +206,29 @@ string msg_str(const char *fmt, ...)
   vsnprintf(message, MSG_SZ - 1, fmt, args);
   return message;
 }
+
+string json_str(const string &str)
+{
+  string quoted = "\"";
+  for (char c : str) {
+    if (c == '"' || c == '\\')
+      quoted += string("\\") + c;
+    else if (c == '\n')
+      quoted += "\\n";
+    else if ((unsigned char)c < 0x20)
+      quoted += msg_str("\\u%04x", c);
+    else
+      quoted += c;
+  }
+  return quoted + "\"";
+}
+
+long peak_rss_kb()
+{
+#ifdef HAVE_SYS_RESOURCE_H
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+    return usage.ru_maxrss; // kilobytes on Linux and the BSDs
+#endif
+  return -1;
+}
@@ -29,6 +29,7 @@
 #define UTILS_H
 
 #include "status.h"
+#include <functional>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string>
@@ -45,6 +46,15 @@ const size_t MSG_SZ = 256;
  *  was read, otherwise \c false.*/
 Status read_int(const char *str, int *i);
 
+/// Read a floating point number from a string.
+/** The string should only hold the number, but may
+ *  have leading and trailing whitespace.
+ * \param str the string holding the number.
+ * \param f used to return the number.
+ * \return status, evaluates to \c true if a valid number
+ *  was read, otherwise \c false.*/
+Status read_double(const char *str, double *f);
+
 /// Read a line of arbitrary length
 /** The caller is responsible for freeing the memory allocated to line
  *  after each read.
@@ -74,6 +84,16 @@ int split_line(char *line, std::vector<char *> &parts,
  * \return A pointer to the opened file stream. */
 FILE *fopen_file(std::string &fpath);
 
+/// Replace the contents of a file
+/** The contents are written to a temporary file, which is then renamed
+ *  to the file, so the file is never left partly written, and is kept
+ *  unchanged if the write fails.
+ * \param fpath the path to the file.
+ * \param write_fn writes the contents to the stream it is passed.
+ * \return status, evaluates to \c true if the file was replaced. */
+Status replace_file(const std::string &fpath,
+                    const std::function<void(FILE *)> &write_fn);
+
 /// Convert a C formated message string to a C++ string
 /** Converts the first MSG_SZ-1 characters of the C format string
  * \param fmt the formatted string
@@ -81,6 +101,15 @@ FILE *fopen_file(std::string &fpath);
  * \return The converted string. */
 std::string msg_str(const char *fmt, ...);
 
+/// Quote a string for JSON
+/**\param str the string.
+ * \return The string in double quotes, with special characters escaped. */
+std::string json_str(const std::string &str);
+
+/// Get the peak resident memory of the process
+/**\return the peak in kilobytes, or -1 if it is not known. */
+long peak_rss_kb();
+
 /// Convert an integer to a string
 /**\param buf a buffer to return the string.
  * \param i the integer.
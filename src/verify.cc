@@ -0,0 +1,131 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file verify.cc
+   \brief independent check of knotting solutions
+*/
+
+#include "verify.h"
+#include "knotcolors.h"
+#include "pattern.h"
+#include "solutions.h"
+#include "utils.h"
+
+using std::vector;
+
+SolutionVerifier::SolutionVerifier(const KnotColors &k, bool pure)
+    : kc(k), prefer_pure(pure), line_start(k.knots.size() + 1),
+      strs(k.num_strings)
+{
+  line_start[0] = 0;
+  for (unsigned int i = 0; i < k.knots.size(); i++)
+    line_start[i + 1] = line_start[i] + (k.knots[i].size() + 63) / 64;
+  packed.resize(line_start.back());
+}
+
+Status SolutionVerifier::check(const unsigned char *strings,
+                               const uint64_t *knots, int *score)
+{
+  const int num_lines = kc.knots.size();
+  for (int i = 0; i < kc.num_strings; i++)
+    strs[i] = strings[i];
+
+  int scr = 0;
+  for (int line = 0; line < num_lines; line++) {
+    const vector<int> &knot_cols = kc.knots[line];
+    const int nk = knot_cols.size();
+    const int offset = line % 2;
+    const uint64_t *words = knots + line_start[line];
+    for (int j = 0; j < nk; j++) {
+      const int w = j / 64;
+      const int bits = (nk - 64 * w < 64) ? nk - 64 * w : 64;
+      const bool swap = (words[w] >> (bits - 1 - j % 64)) & 1;
+      int &left = strs[offset + 2 * j];
+      int &right = strs[offset + 2 * j + 1];
+      if (knot_cols[j] != left && knot_cols[j] != right)
+        return Status::error(
+            msg_str("line %d, knot %d: colour %c is not met by strings %c "
+                    "and %c",
+                    line + 1, j + 1, kc.get_colour(knot_cols[j]),
+                    kc.get_colour(left), kc.get_colour(right)));
+      if (left == right && swap != prefer_pure)
+        return Status::error(
+            msg_str("line %d, knot %d: strings of the same colour are %s "
+                    "(redundant solution)",
+                    line + 1, j + 1, swap ? "swapped" : "not swapped"));
+      scr += swap != prefer_pure;
+      if (swap)
+        std::swap(left, right);
+    }
+  }
+
+  for (int i = 0; i < kc.num_strings; i++)
+    if (strs[i] != strings[i])
+      return Status::error(
+          msg_str("string %d: leaves the last line as %c, but starts as %c",
+                  i + 1, kc.get_colour(strs[i]), kc.get_colour(strings[i])));
+
+  if (score)
+    *score = scr;
+  return Status::ok();
+}
+
+Status SolutionVerifier::check(const SolutionStore &sols, size_t idx)
+{
+  int scr;
+  Status stat = check(sols.get_strings(idx), sols.get_knots(idx), &scr);
+  if (stat.is_ok() && scr != sols.score(idx))
+    stat.set_error(msg_str("score is %d, but was given as %d", scr,
+                           sols.score(idx)));
+  return stat;
+}
+
+Status SolutionVerifier::check(const Pattern &pat, int *score)
+{
+  if ((int)pat.strings.size() != kc.num_strings ||
+      pat.knots.size() != kc.knots.size())
+    return Status::error("solution is not the size of the design");
+
+  vector<unsigned char> strings(pat.strings.begin(), pat.strings.end());
+  for (unsigned int i = 0; i < kc.knots.size(); i++) {
+    const vector<int> &knots_line = pat.knots[i];
+    if (knots_line.size() != kc.knots[i].size())
+      return Status::error(
+          msg_str("line %d: solution is not the size of the design", i + 1));
+    uint64_t *words = &packed[line_start[i]];
+    for (int w = 0; w < (int)knots_line.size(); w += 64) {
+      uint64_t word = 0;
+      for (int j = w; j < (int)knots_line.size() && j < w + 64; j++)
+        word = (word << 1) | (knots_line[j] != 0);
+      words[w / 64] = word;
+    }
+  }
+
+  int scr;
+  Status stat = check(strings.data(), packed.data(), &scr);
+  if (score)
+    *score = scr;
+  else if (stat.is_ok() && scr != pat.score)
+    stat.set_error(msg_str("score is %d, but was given as %d", scr,
+                           pat.score));
+  return stat;
+}
@@ -0,0 +1,83 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file verify.h
+   \brief independent check of knotting solutions
+*/
+
+#ifndef VERIFY_H
+#define VERIFY_H
+
+#include "status.h"
+#include <stdint.h>
+#include <vector>
+
+class KnotColors;
+class Pattern;
+class SolutionStore;
+
+/// Check knotting solutions against a design
+/** A solution is replayed from its start strings, line by line, with the
+ *  same rules as get_next_strings(): every knot must be met by one of its
+ *  two strings, strings of the same colour must be knotted the way of the
+ *  prefered knot type, and the strings leaving the last line must be the
+ *  start strings. The score is counted as the solution is replayed. The
+ *  check works on the packed knots of a SolutionStore and allocates no
+ *  memory, so that very many solutions can be checked. */
+class SolutionVerifier {
+private:
+  const KnotColors &kc;
+  bool prefer_pure;
+  std::vector<int> line_start;  // index of first word of each line
+  std::vector<int> strs;        // strings entering the current line
+  std::vector<uint64_t> packed; // knots of a Pattern, packed
+
+public:
+  /// Constructor
+  /**\param k the design.
+   * \param pure whether the solutions prefer pure knots. */
+  SolutionVerifier(const KnotColors &k, bool pure);
+
+  /// Check a solution
+  /**\param strings the start strings, one byte for each string.
+   * \param knots the knots of each line, packed as in a SolutionStore.
+   * \param score used to return the score, if not \c nullptr.
+   * \return status, evaluates to \c true if the solution is valid,
+   *  otherwise the message gives the first fault found. */
+  Status check(const unsigned char *strings, const uint64_t *knots,
+               int *score = nullptr);
+
+  /// Check a solution held in a store, including its score
+  /**\param sols the solution store.
+   * \param idx the index of the solution.
+   * \return status, evaluates to \c true if the solution is valid. */
+  Status check(const SolutionStore &sols, size_t idx);
+
+  /// Check a solution held in a pattern
+  /**\param pat the pattern, with start strings and knots.
+   * \param score used to return the score, if not \c nullptr, otherwise
+   *  the score must match the pattern score.
+   * \return status, evaluates to \c true if the solution is valid. */
+  Status check(const Pattern &pat, int *score = nullptr);
+};
+
+#endif // VERIFY_H
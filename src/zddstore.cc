@@ -0,0 +1,339 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "zddstore.h"
+#include "knotcolors.h"
+#include "pattern.h"
+#include <limits.h>
+#include <string.h>
+#include <string>
+
+using std::string;
+using std::vector;
+
+ZddStore::ZddStore() : num_strings(0), prefer_pure(true), best_score(INT_MAX)
+{
+  init_terminals();
+}
+
+void ZddStore::init_terminals()
+{
+  nodes.clear();
+  nodes.push_back({INT_MAX, 0, 0}); // empty set
+  nodes.push_back({INT_MAX, 1, 1}); // empty solution
+  unique.clear();
+  unions.clear();
+  node_cnts.clear();
+}
+
+void ZddStore::init(const KnotColors &k, bool pure)
+{
+  num_strings = k.num_strings;
+  prefer_pure = pure;
+  line_var.resize(k.knots.size() + 1);
+  int var = 0;
+  for (unsigned int i = 0; i < k.knots.size(); i++) {
+    line_var[i] = var;
+    var += k.knots[i].size();
+  }
+  line_var.back() = var;
+  best_score = INT_MAX;
+  roots.clear();
+  init_terminals();
+}
+
+ZddStore::NodeId ZddStore::make_node(int var, NodeId lo, NodeId hi)
+{
+  if (hi == 0) // zero-suppressed
+    return lo;
+  const Node node = {var, lo, hi};
+  auto it = unique.find(node);
+  if (it != unique.end())
+    return it->second;
+  const NodeId id = nodes.size();
+  nodes.push_back(node);
+  unique.emplace(node, id);
+  return id;
+}
+
+ZddStore::NodeId ZddStore::make_union(NodeId a, NodeId b)
+{
+  if (a == 0 || a == b)
+    return b;
+  if (b == 0)
+    return a;
+  if (a > b)
+    std::swap(a, b);
+  const std::pair<NodeId, NodeId> key(a, b);
+  auto it = unions.find(key);
+  if (it != unions.end())
+    return it->second;
+
+  // copy the nodes, as making nodes may reallocate the node list
+  const Node na = nodes[a];
+  const Node nb = nodes[b];
+  NodeId id;
+  if (na.var < nb.var)
+    id = make_node(na.var, make_union(na.lo, b), na.hi);
+  else if (na.var > nb.var)
+    id = make_node(nb.var, make_union(a, nb.lo), nb.hi);
+  else
+    id = make_node(na.var, make_union(na.lo, nb.lo), make_union(na.hi, nb.hi));
+  unions.emplace(key, id);
+  return id;
+}
+
+ZddStore::NodeId ZddStore::make_chain(int line, const vector<int> &knots,
+                                      NodeId next)
+{
+  for (int i = (int)knots.size() - 1; i >= 0; i--)
+    if (knots[i])
+      next = make_node(line_var[line] + i, 0, next);
+  return next;
+}
+
+// Remove the nodes that can't be reached from a root
+void ZddStore::compact()
+{
+  vector<bool> used(nodes.size(), false);
+  used[0] = used[1] = true;
+  for (const auto &root : roots)
+    used[root.node] = true;
+  for (size_t i = nodes.size(); i-- > 2;) // parents before children
+    if (used[i])
+      used[nodes[i].lo] = used[nodes[i].hi] = true;
+
+  vector<NodeId> new_ids(nodes.size(), 0);
+  vector<Node> old_nodes;
+  old_nodes.swap(nodes);
+  init_terminals();
+  new_ids[1] = 1;
+  for (size_t i = 2; i < old_nodes.size(); i++)
+    if (used[i]) {
+      const Node &node = old_nodes[i];
+      new_ids[i] = make_node(node.var, new_ids[node.lo], new_ids[node.hi]);
+    }
+  for (auto &root : roots)
+    root.node = new_ids[root.node];
+}
+
+// key for a search state, the strings entering a line and the score so far
+static string state_key(const vector<int> &strings, int score)
+{
+  string key(strings.begin(), strings.end());
+  key.append((const char *)&score, sizeof(score));
+  return key;
+}
+
+static int state_score(const string &key)
+{
+  int score;
+  memcpy(&score, key.data() + key.size() - sizeof(score), sizeof(score));
+  return score;
+}
+
+bool ZddStore::add(const KnotColors &k, const vector<int> &strings,
+                   int strs_no, int perm_no, bool only_symmetric)
+{
+  // Find the states entering each line, with a score that could be
+  // the best, and then make the diagram for each state from the last
+  // line back to the first. States that don't lead to a solution with
+  // the best score for the strings are given the empty set.
+  const int num_lines = k.knots.size();
+  vector<std::unordered_map<string, NodeId>> layers(num_lines + 1);
+  layers[0].emplace(state_key(strings, 0), 0);
+  for (int line = 0; line < num_lines; line++) {
+    for (const auto &kp : layers[line]) {
+      const vector<int> strings_in(kp.first.begin(),
+                                   kp.first.begin() + num_strings);
+      const int score = state_score(kp.first);
+      auto add_state = [&](const vector<int> &, const vector<int> &str_out,
+                           int line_score) {
+        if (score + line_score <= best_score)
+          layers[line + 1].emplace(state_key(str_out, score + line_score), 0);
+      };
+      for_each_line_knots(k, line, strings_in, strings, prefer_pure,
+                          only_symmetric, add_state);
+    }
+  }
+
+  // all the final states have the start strings
+  int score = INT_MAX;
+  for (const auto &kp : layers[num_lines])
+    score = std::min(score, state_score(kp.first));
+  if (score == INT_MAX)
+    return false;
+  layers[num_lines][state_key(strings, score)] = 1;
+
+  for (int line = num_lines - 1; line >= 0; line--) {
+    const auto &next_layer = layers[line + 1];
+    for (auto &kp : layers[line]) {
+      const vector<int> strings_in(kp.first.begin(),
+                                   kp.first.begin() + num_strings);
+      const int cur_score = state_score(kp.first);
+      NodeId node = 0;
+      auto add_knots = [&](const vector<int> &knots, const vector<int> &str_out,
+                           int line_score) {
+        auto it = next_layer.find(state_key(str_out, cur_score + line_score));
+        if (it != next_layer.end() && it->second)
+          node = make_union(node, make_chain(line, knots, it->second));
+      };
+      for_each_line_knots(k, line, strings_in, strings, prefer_pure,
+                          only_symmetric, add_knots);
+      kp.second = node;
+    }
+    layers[line + 1].clear();
+  }
+  unions.clear();
+
+  const Root root = {strings, strs_no, perm_no, layers[0].begin()->second};
+  roots.push_back(root);
+  node_cnts.clear();
+  if (score < best_score) { // replace the solutions with a worse score
+    best_score = score;
+    roots.erase(roots.begin(), roots.end() - 1);
+    compact();
+  }
+  return true;
+}
+
+const vector<BigCount> &ZddStore::get_node_counts() const
+{
+  if (node_cnts.size() != nodes.size()) {
+    node_cnts.resize(nodes.size());
+    node_cnts[0] = BigCount(0);
+    node_cnts[1] = BigCount(1);
+    for (size_t i = 2; i < nodes.size(); i++) { // children before parents
+      node_cnts[i] = node_cnts[nodes[i].lo];
+      node_cnts[i] += node_cnts[nodes[i].hi];
+    }
+  }
+  return node_cnts;
+}
+
+BigCount ZddStore::count() const
+{
+  const vector<BigCount> &cnts = get_node_counts();
+  BigCount total;
+  for (const auto &root : roots)
+    total += cnts[root.node];
+  return total;
+}
+
+void ZddStore::set_pattern(Pattern &pat, size_t root_idx, int var_no,
+                           const vector<bool> &swaps) const
+{
+  const Root &root = roots[root_idx];
+  pat.strings = root.strings;
+  pat.knots.resize(line_var.size() - 1);
+  for (unsigned int i = 0; i < pat.knots.size(); i++) {
+    pat.knots[i].resize(line_var[i + 1] - line_var[i]);
+    for (unsigned int j = 0; j < pat.knots[i].size(); j++)
+      pat.knots[i][j] = swaps[line_var[i] + j];
+  }
+  pat.score = best_score;
+  pat.prefer_pure = prefer_pure;
+  pat.soln_strs_no = root.strs_no;
+  pat.soln_perm_no = root.perm_no;
+  pat.soln_var_no = var_no;
+}
+
+bool ZddStore::sample(std::mt19937_64 &rng, Pattern &pat) const
+{
+  const vector<BigCount> &cnts = get_node_counts();
+  BigCount rnd = count().random_below(rng);
+  for (size_t i = 0; i < roots.size(); i++) {
+    if (!(rnd < cnts[roots[i].node])) {
+      rnd -= cnts[roots[i].node];
+      continue;
+    }
+
+    // the solutions of a node are ordered with those of its lo node first
+    const uint64_t var_no = rnd.low_bits();
+    vector<bool> swaps(line_var.back(), false);
+    NodeId node = roots[i].node;
+    while (node > 1) {
+      const Node &n = nodes[node];
+      if (rnd < cnts[n.lo])
+        node = n.lo;
+      else {
+        rnd -= cnts[n.lo];
+        swaps[n.var] = true;
+        node = n.hi;
+      }
+    }
+    set_pattern(pat, i, (var_no < INT_MAX) ? (int)var_no : -1, swaps);
+    return true;
+  }
+  return false;
+}
+
+ZddStore::Enumerator::Enumerator(const ZddStore &zdd)
+    : store(zdd), root_idx(0), var_no(0)
+{
+}
+
+// follow the first solution of a node, with its lo nodes first
+bool ZddStore::Enumerator::descend(NodeId node)
+{
+  while (node > 1) {
+    const Node &n = store.nodes[node];
+    path.push_back(std::make_pair(node, n.lo == 0));
+    node = (n.lo) ? n.lo : n.hi;
+  }
+  return node == 1;
+}
+
+bool ZddStore::Enumerator::next(Pattern &pat)
+{
+  while (root_idx < store.roots.size()) {
+    bool found = false;
+    if (var_no == 0) // first solution of root
+      found = descend(store.roots[root_idx].node);
+    else {
+      // take the hi branch of the last node where the lo branch was taken
+      while (!path.empty()) {
+        if (!path.back().second) {
+          path.back().second = true;
+          found = descend(store.nodes[path.back().first].hi);
+          break;
+        }
+        path.pop_back();
+      }
+    }
+
+    if (found) {
+      vector<bool> swaps(store.line_var.back(), false);
+      for (const auto &step : path)
+        if (step.second)
+          swaps[store.nodes[step.first].var] = true;
+      store.set_pattern(pat, root_idx, var_no++, swaps);
+      return true;
+    }
+
+    root_idx++;
+    var_no = 0;
+    path.clear();
+  }
+  return false;
+}
@@ -0,0 +1,173 @@
+/*
+   Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+                           http://www.antiprism.com/other/bracelet_solver/
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file zddstore.h
+   \brief store of knotting solutions as a zero-suppressed decision diagram
+*/
+
+#ifndef ZDDSTORE_H
+#define ZDDSTORE_H
+
+#include "solutioncount.h"
+#include <random>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+class KnotColors;
+class Pattern;
+
+/// Store of the solutions with the best score, as decision diagrams
+/** Each knot of the design is a variable, numbered line by line, which is
+ *  included in a solution if the knot swaps its strings. The knottings
+ *  of each set of start strings are held as a zero-suppressed decision
+ *  diagram (ZDD), and the diagrams share their nodes. The memory used
+ *  depends on the structure of the solution set, rather than its size.
+ *  The solutions can be counted, sampled uniformly at random, and
+ *  enumerated, in the order they would be found by a search, without
+ *  making the whole set. */
+class ZddStore {
+public:
+  /// Node index. Node 0 is the empty set, and node 1 holds the empty solution
+  typedef uint32_t NodeId;
+
+  /// Node of the diagram
+  struct Node {
+    int var;   ///< knot variable
+    NodeId lo; ///< solutions where the knot doesn't swap
+    NodeId hi; ///< solutions where the knot swaps
+  };
+
+  /// Knottings for a set of start strings
+  struct Root {
+    std::vector<int> strings; ///< start strings
+    int strs_no;              ///< set of free colours
+    int perm_no;              ///< permutation of free colours
+    NodeId node;              ///< diagram of knottings
+  };
+
+  /// Enumerate the solutions in order
+  class Enumerator {
+  private:
+    const ZddStore &store;
+    size_t root_idx;                           // current root
+    int var_no;                                // solution of root
+    std::vector<std::pair<NodeId, bool>> path; // nodes and choices
+    bool descend(NodeId node);
+
+  public:
+    /// Constructor
+    /**\param zdd the store to enumerate. */
+    Enumerator(const ZddStore &zdd);
+
+    /// Get the next solution
+    /**\param pat used to return the solution.
+     * \return \c false if there are no more solutions. */
+    bool next(Pattern &pat);
+  };
+
+private:
+  struct NodeHash {
+    size_t operator()(const Node &n) const
+    {
+      return ((size_t)n.var * 0x9e3779b97f4a7c15ULL) ^
+             ((size_t)n.lo * 0xc2b2ae3d27d4eb4fULL) ^ n.hi;
+    }
+  };
+  struct NodeEqual {
+    bool operator()(const Node &a, const Node &b) const
+    {
+      return a.var == b.var && a.lo == b.lo && a.hi == b.hi;
+    }
+  };
+  struct PairHash {
+    size_t operator()(const std::pair<NodeId, NodeId> &p) const
+    {
+      return ((size_t)p.first * 0x9e3779b97f4a7c15ULL) ^ p.second;
+    }
+  };
+
+  int num_strings;
+  bool prefer_pure;
+  std::vector<int> line_var;       // first variable of each line, and end
+  int best_score;                  // score of the solutions
+  std::vector<Node> nodes;         // nodes, children before parents
+  std::unordered_map<Node, NodeId, NodeHash, NodeEqual> unique;
+  std::unordered_map<std::pair<NodeId, NodeId>, NodeId, PairHash> unions;
+  std::vector<Root> roots;
+  mutable std::vector<BigCount> node_cnts; // counts, made when needed
+
+  void init_terminals();
+  NodeId make_node(int var, NodeId lo, NodeId hi);
+  NodeId make_union(NodeId a, NodeId b);
+  NodeId make_chain(int line, const std::vector<int> &knots, NodeId next);
+  void compact();
+  const std::vector<BigCount> &get_node_counts() const;
+  void set_pattern(Pattern &pat, size_t root_idx, int var_no,
+                   const std::vector<bool> &swaps) const;
+
+public:
+  /// Constructor
+  ZddStore();
+
+  /// Initialise the store for a design, removing all solutions
+  /**\param k the design.
+   * \param pure whether the solutions prefer pure knots. */
+  void init(const KnotColors &k, bool pure);
+
+  /// Add the best solutions for a set of start strings
+  /** The solutions are only added if their score is not worse than the
+   *  score of the solutions in the store, and replace those solutions if
+   *  it is better.
+   * \param k the design.
+   * \param strings the start strings.
+   * \param strs_no the set of free colours.
+   * \param perm_no the permutation of free colours.
+   * \param only_symmetric only add symmetric knottings.
+   * \return \c true if solutions were added. */
+  bool add(const KnotColors &k, const std::vector<int> &strings, int strs_no,
+           int perm_no, bool only_symmetric);
+
+  /// Get the score of the solutions
+  /**\return the score, or \c INT_MAX if there are no solutions. */
+  int score() const { return best_score; }
+
+  /// Get the number of sets of start strings with solutions
+  /**\return the number of sets. */
+  size_t num_roots() const { return roots.size(); }
+
+  /// Get the number of nodes used
+  /**\return the number of nodes. */
+  size_t num_nodes() const { return nodes.size(); }
+
+  /// Count the solutions
+  /**\return the number of solutions. */
+  BigCount count() const;
+
+  /// Get a solution chosen uniformly at random
+  /**\param rng the random number generator.
+   * \param pat used to return the solution.
+   * \return \c false if there are no solutions. */
+  bool sample(std::mt19937_64 &rng, Pattern &pat) const;
+};
+
+#endif // ZDDSTORE_H
@@ -0,0 +1,77 @@
+#!/bin/sh
+# Copyright (c) 2014-2017 Adrian Rossiter <adrian@antiprism.com>
+#                        http://www.antiprism.com/other/bracelet_solver/
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+#   The above copyright notice and this permission notice shall be included
+#   in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+
+# Check behaviour of the command line programs that is not covered by
+# comparing search results: option parsing, limits and exit statuses.
+# Run with the directory holding the built programs, as by make check.
+
+src_dir=${1:-src}
+solver="$src_dir/bracelet_solver"
+gen_design="$src_dir/gen_design"
+tmp_dir=$(mktemp -d "${TMPDIR:-/tmp}/check_cli.XXXXXX") || exit 1
+trap 'rm -rf "$tmp_dir"' EXIT
+
+num_failed=0
+
+# report the result of a check, given its name and exit status
+check()
+{
+  if [ "$2" -eq 0 ]; then
+    echo "ok:     $1"
+  else
+    echo "FAILED: $1"
+    num_failed=$((num_failed + 1))
+  fi
+}
+
+# Options may come after the design file, with long option arguments as
+# separate words or after =
+design="$tmp_dir/design.txt"
+printf 'bab\nbcb\nbca\naaa\n' > "$design"
+for opts in "--max-solutions 2" "--max-solutions=2" "-m --max-solutions 2"; do
+  num_solns=$("$solver" -q "$design" $opts | grep -c '^SOLUTION')
+  [ "$num_solns" = 2 ]
+  check "options after the design file: $opts" $?
+done
+"$solver" -q "$design" --format json --seed 3 | grep -q '^{"program"'
+check "options after the design file: --format json --seed 3" $?
+"$solver" -q --max-solutions "$design" > /dev/null 2>&1
+[ $? -ne 0 ]
+check "a long option takes the next word as its argument" $?
+
+# The anneal engine stops close to its time limit, even when a single
+# round of a large design takes minutes
+"$gen_design" -w 120 -l 60 -s 1 > "$tmp_dir/large.txt"
+start=$(date +%s)
+"$solver" -q --engine anneal --time-limit 1 "$tmp_dir/large.txt" \
+    > /dev/null 2>&1
+status=$?
+secs=$(($(date +%s) - start))
+[ $status -eq 0 ] && [ $secs -le 3 ]
+check "anneal --time-limit 1 on a 120 string design ($secs s)" $?
+
+echo
+if [ $num_failed -gt 0 ]; then
+  echo "$num_failed checks failed"
+  exit 1
+fi
+echo "all checks passed"